@@ -0,0 +1,362 @@
+#include "adapter-selector.h"
+#include "cpu-profiler.h"
+#include "webgpu-utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <ostream>
+
+using namespace wgpu;
+
+namespace
+{
+    const char* GetBackendName(BackendType backendType)
+    {
+        switch (backendType)
+        {
+        case BackendType::Null: return "Null";
+        case BackendType::WebGPU: return "WebGPU";
+        case BackendType::D3D11: return "D3D11";
+        case BackendType::D3D12: return "D3D12";
+        case BackendType::Metal: return "Metal";
+        case BackendType::Vulkan: return "Vulkan";
+        case BackendType::OpenGL: return "OpenGL";
+        case BackendType::OpenGLES: return "OpenGLES";
+        default: return "Undefined";
+        }
+    }
+
+    const char* GetAdapterTypeName(AdapterType adapterType)
+    {
+        switch (adapterType)
+        {
+        case AdapterType::DiscreteGPU: return "discrete";
+        case AdapterType::IntegratedGPU: return "integrated";
+        case AdapterType::CPU: return "cpu";
+        default: return "unknown";
+        }
+    }
+
+    std::optional<double> ReadNumber(const std::string& line, const char* key)
+    {
+        const std::string pattern = std::string("\"") + key + "\": ";
+        const size_t position = line.find(pattern);
+        if (position == std::string::npos)
+        {
+            return std::nullopt;
+        }
+        return std::strtod(line.c_str() + position + pattern.size(), nullptr);
+    }
+
+    bool ReadBool(const std::string& line, const char* key)
+    {
+        return line.find(std::string("\"") + key + "\": true") != std::string::npos;
+    }
+
+    std::string ReadString(const std::string& line, const char* key)
+    {
+        const std::string pattern = std::string("\"") + key + "\": \"";
+        const size_t start = line.find(pattern);
+        if (start == std::string::npos)
+        {
+            return {};
+        }
+        const size_t end = line.find('"', start + pattern.size());
+        return line.substr(start + pattern.size(), end == std::string::npos ? std::string::npos : end - start - pattern.size());
+    }
+
+    bool IsSameDevice(const AdapterSelector::Candidate& a, const AdapterSelector::Candidate& b)
+    {
+        return a.vendorID == b.vendorID && a.deviceID == b.deviceID && a.backendType == b.backendType && a.fallback == b.fallback;
+    }
+}
+
+Adapter AdapterSelector::Select(Instance instance, Surface surface, const Options& options)
+{
+    PROFILE_FUNCTION();
+    m_UsedCache = false;
+    m_SelectedIndex = -1;
+    m_Candidates.clear();
+
+    // The cached favorite is requested directly and taken when the same device answers
+    if (!options.cachePath.empty() && LoadCache(options.cachePath) && !options.rescan)
+    {
+        if (const Candidate* best = GetBest(options))
+        {
+            Adapter adapter = Request(instance, surface, best->powerPreference, best->backendType, best->fallback, options.timeoutSeconds);
+            if (adapter)
+            {
+                Candidate found = Inspect(adapter);
+                found.fallback = best->fallback;
+                if (IsSameDevice(found, *best))
+                {
+                    m_UsedCache = true;
+                    m_SelectedIndex = static_cast<int>(best - m_Candidates.data());
+                    return adapter;
+                }
+                adapter.release();
+            }
+        }
+    }
+
+    // Adapters the cache knows but this enumeration does not look for survive the rewrite
+    std::vector<Candidate> cached = std::move(m_Candidates);
+    m_Candidates.clear();
+    std::vector<Adapter> adapters;
+    auto consider = [&](PowerPreference powerPreference, BackendType backendType, bool fallback)
+    {
+        Adapter adapter = Request(instance, surface, powerPreference, backendType, fallback, options.timeoutSeconds);
+        if (!adapter)
+        {
+            return;
+        }
+        Candidate candidate = Inspect(adapter);
+        candidate.powerPreference = powerPreference;
+        candidate.fallback = fallback;
+        candidate.score = Score(candidate);
+        auto same = [&](const Candidate& other) { return IsSameDevice(other, candidate); };
+        if (std::any_of(m_Candidates.begin(), m_Candidates.end(), same))
+        {
+            adapter.release();
+            return;
+        }
+        m_Candidates.push_back(candidate);
+        adapters.push_back(adapter);
+    };
+#ifdef __EMSCRIPTEN__
+    // The browser exposes one adapter per power preference and no backend choice
+    consider(PowerPreference::HighPerformance, BackendType::Undefined, options.fallbackOnly);
+#else
+    if (!options.fallbackOnly)
+    {
+        for (BackendType backendType : { BackendType::D3D12, BackendType::Metal, BackendType::Vulkan, BackendType::D3D11, BackendType::OpenGL, BackendType::OpenGLES })
+        {
+            for (PowerPreference powerPreference : { PowerPreference::HighPerformance, PowerPreference::LowPower })
+            {
+                consider(powerPreference, backendType, false);
+            }
+        }
+    }
+    // The CPU adapter is always in the report, it is the last resort without a GPU
+    consider(PowerPreference::HighPerformance, BackendType::Undefined, true);
+#endif
+
+    Adapter selected = nullptr;
+    if (const Candidate* best = GetBest(options))
+    {
+        m_SelectedIndex = static_cast<int>(best - m_Candidates.data());
+        selected = adapters[m_SelectedIndex];
+    }
+    for (size_t i = 0; i < adapters.size(); ++i)
+    {
+        if (static_cast<int>(i) != m_SelectedIndex)
+        {
+            adapters[i].release();
+        }
+    }
+
+    if (!options.cachePath.empty())
+    {
+        for (const Candidate& candidate : cached)
+        {
+            auto same = [&](const Candidate& other) { return IsSameDevice(other, candidate); };
+            if ((options.fallbackOnly && !candidate.fallback) && std::none_of(m_Candidates.begin(), m_Candidates.end(), same))
+            {
+                m_Candidates.push_back(candidate);
+            }
+        }
+        SaveCache(options.cachePath);
+    }
+    return selected;
+}
+
+void AdapterSelector::PrintReport(std::ostream& out) const
+{
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(0) << "Adapters" << (m_UsedCache ? " (cached)" : "") << ":\n";
+    for (size_t i = 0; i < m_Candidates.size(); ++i)
+    {
+        const Candidate& candidate = m_Candidates[i];
+        out << (static_cast<int>(i) == m_SelectedIndex ? "  * " : "    ") << std::left << std::setw(32) << candidate.name << std::right
+            << ' ' << std::setw(8) << GetBackendName(candidate.backendType) << ' ' << std::setw(10) << GetAdapterTypeName(candidate.adapterType)
+            << std::hex << "  0x" << candidate.vendorID << ":0x" << candidate.deviceID << std::dec
+            << (candidate.timestampQuery ? "  timestamps" : "") << (candidate.shaderF16 ? "  f16" : "")
+            << "  score " << candidate.score << '\n';
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+double AdapterSelector::Score(const Candidate& candidate)
+{
+    double score = 0.0;
+    switch (candidate.adapterType)
+    {
+    case AdapterType::DiscreteGPU: score += 400.0; break;
+    case AdapterType::IntegratedGPU: score += 300.0; break;
+    case AdapterType::CPU: score += 50.0; break;
+    default: score += 100.0; break;
+    }
+    switch (candidate.backendType)
+    {
+    case BackendType::D3D12:
+    case BackendType::Metal:
+    case BackendType::Vulkan:
+        score += 100.0;
+        break;
+    case BackendType::D3D11:
+        score += 60.0;
+        break;
+    case BackendType::OpenGL:
+    case BackendType::OpenGLES:
+        score += 40.0;
+        break;
+    default:
+        break;
+    }
+    score += (candidate.timestampQuery ? 30.0 : 0.0) + (candidate.shaderF16 ? 30.0 : 0.0) + (candidate.indirectFirstInstance ? 30.0 : 0.0);
+    // Each doubling above the WebGPU defaults is worth a little, the type and backend still dominate
+    auto doublings = [](double value, double base) { return value > 0.0 ? std::log2(value / base) : 0.0; };
+    score += 5.0 * doublings(static_cast<double>(candidate.maxBufferSize), 256.0 * 1024 * 1024);
+    score += 5.0 * doublings(static_cast<double>(candidate.maxStorageBufferBindingSize), 128.0 * 1024 * 1024);
+    score += 5.0 * doublings(candidate.maxTextureDimension2D, 8192.0);
+    score += 5.0 * doublings(candidate.maxComputeInvocationsPerWorkgroup, 256.0);
+    return score;
+}
+
+Adapter AdapterSelector::Request(Instance instance, Surface surface, PowerPreference powerPreference,
+    BackendType backendType, bool fallback, double timeoutSeconds) const
+{
+    RequestAdapterOptions requestOptions
+    {{
+        .compatibleSurface = surface,
+        .powerPreference = powerPreference,
+        .backendType = backendType,
+        .forceFallbackAdapter = fallback,
+    }};
+    auto request = requestAdapterAsync(instance, &requestOptions);
+    if (!waitForRequest(instance, *request, timeoutSeconds, false))
+    {
+        return nullptr;
+    }
+    return request->result;
+}
+
+AdapterSelector::Candidate AdapterSelector::Inspect(Adapter adapter)
+{
+    AdapterProperties properties = Default;
+    adapter.getProperties(&properties);
+    SupportedLimits supportedLimits = Default;
+    adapter.getLimits(&supportedLimits);
+
+    Candidate candidate;
+    candidate.name = properties.name ? properties.name : "";
+    // The name ends up in a JSON string on a single line of the cache, which ReadString reads back
+    // without unescaping: quotes and backslashes are swapped for harmless characters and control
+    // characters are dropped
+    std::replace(candidate.name.begin(), candidate.name.end(), '"', '\'');
+    std::replace(candidate.name.begin(), candidate.name.end(), '\\', '/');
+    candidate.name.erase(std::remove_if(candidate.name.begin(), candidate.name.end(), [](char c) {
+        return static_cast<unsigned char>(c) < 0x20 || c == 0x7f;
+    }), candidate.name.end());
+    candidate.vendorID = properties.vendorID;
+    candidate.deviceID = properties.deviceID;
+    candidate.backendType = properties.backendType;
+    candidate.adapterType = properties.adapterType;
+    candidate.timestampQuery = adapter.hasFeature(FeatureName::TimestampQuery);
+    candidate.shaderF16 = adapter.hasFeature(FeatureName::ShaderF16);
+    candidate.indirectFirstInstance = adapter.hasFeature(FeatureName::IndirectFirstInstance);
+    candidate.maxTextureDimension2D = supportedLimits.limits.maxTextureDimension2D;
+    candidate.maxBufferSize = supportedLimits.limits.maxBufferSize;
+    candidate.maxStorageBufferBindingSize = supportedLimits.limits.maxStorageBufferBindingSize;
+    candidate.maxComputeInvocationsPerWorkgroup = supportedLimits.limits.maxComputeInvocationsPerWorkgroup;
+    return candidate;
+}
+
+const AdapterSelector::Candidate* AdapterSelector::GetBest(const Options& options) const
+{
+    const Candidate* best = nullptr;
+    for (const Candidate& candidate : m_Candidates)
+    {
+        if ((!options.fallbackOnly || candidate.fallback) && (!best || candidate.score > best->score))
+        {
+            best = &candidate;
+        }
+    }
+    return best;
+}
+
+bool AdapterSelector::LoadCache(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    // One adapter per line, as SaveCache writes them
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const auto vendorID = ReadNumber(line, "vendorID");
+        const auto deviceID = ReadNumber(line, "deviceID");
+        if (!vendorID || !deviceID)
+        {
+            continue;
+        }
+        Candidate candidate;
+        candidate.name = ReadString(line, "name");
+        candidate.vendorID = static_cast<uint32_t>(*vendorID);
+        candidate.deviceID = static_cast<uint32_t>(*deviceID);
+        candidate.backendType = static_cast<WGPUBackendType>(static_cast<int>(ReadNumber(line, "backendType").value_or(0)));
+        candidate.adapterType = static_cast<WGPUAdapterType>(static_cast<int>(ReadNumber(line, "adapterType").value_or(0)));
+        candidate.powerPreference = static_cast<WGPUPowerPreference>(static_cast<int>(ReadNumber(line, "powerPreference").value_or(0)));
+        candidate.fallback = ReadBool(line, "fallback");
+        candidate.timestampQuery = ReadBool(line, "timestampQuery");
+        candidate.shaderF16 = ReadBool(line, "shaderF16");
+        candidate.indirectFirstInstance = ReadBool(line, "indirectFirstInstance");
+        candidate.maxTextureDimension2D = static_cast<uint32_t>(ReadNumber(line, "maxTextureDimension2D").value_or(0));
+        candidate.maxBufferSize = static_cast<uint64_t>(ReadNumber(line, "maxBufferSize").value_or(0));
+        candidate.maxStorageBufferBindingSize = static_cast<uint64_t>(ReadNumber(line, "maxStorageBufferBindingSize").value_or(0));
+        candidate.maxComputeInvocationsPerWorkgroup = static_cast<uint32_t>(ReadNumber(line, "maxComputeInvocationsPerWorkgroup").value_or(0));
+        // Scored again, the cache outlives changes to the scoring
+        candidate.score = Score(candidate);
+        m_Candidates.push_back(candidate);
+    }
+    return !m_Candidates.empty();
+}
+
+bool AdapterSelector::SaveCache(const std::filesystem::path& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    file << "{\n  \"adapters\": [\n";
+    for (size_t i = 0; i < m_Candidates.size(); ++i)
+    {
+        const Candidate& candidate = m_Candidates[i];
+        file << "    { \"vendorID\": " << candidate.vendorID
+             << ", \"deviceID\": " << candidate.deviceID
+             << ", \"name\": \"" << candidate.name << '"'
+             << ", \"backend\": \"" << GetBackendName(candidate.backendType) << '"'
+             << ", \"backendType\": " << static_cast<uint32_t>(static_cast<WGPUBackendType>(candidate.backendType))
+             << ", \"adapterType\": " << static_cast<uint32_t>(static_cast<WGPUAdapterType>(candidate.adapterType))
+             << ", \"powerPreference\": " << static_cast<uint32_t>(static_cast<WGPUPowerPreference>(candidate.powerPreference))
+             << ", \"fallback\": " << (candidate.fallback ? "true" : "false")
+             << ", \"timestampQuery\": " << (candidate.timestampQuery ? "true" : "false")
+             << ", \"shaderF16\": " << (candidate.shaderF16 ? "true" : "false")
+             << ", \"indirectFirstInstance\": " << (candidate.indirectFirstInstance ? "true" : "false")
+             << ", \"maxTextureDimension2D\": " << candidate.maxTextureDimension2D
+             << ", \"maxBufferSize\": " << candidate.maxBufferSize
+             << ", \"maxStorageBufferBindingSize\": " << candidate.maxStorageBufferBindingSize
+             << ", \"maxComputeInvocationsPerWorkgroup\": " << candidate.maxComputeInvocationsPerWorkgroup
+             << ", \"score\": " << candidate.score << " }" << (i + 1 < m_Candidates.size() ? "," : "") << '\n';
+    }
+    file << "  ]\n}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+
+// Picks the adapter instead of taking whatever the power preference hands out. Each combination of
+// backend and power preference (and the CPU fallback) is requested once, and the distinct adapters are
+// scored on type, backend, optional features and limits. The capability report is cached as JSON keyed
+// by vendor and device ID. Later launches request the cached favorite directly and only enumerate
+// again when it does not show up anymore.
+class AdapterSelector
+{
+public:
+    struct Candidate
+    {
+        std::string name;
+        uint32_t vendorID{};
+        uint32_t deviceID{};
+        wgpu::BackendType backendType{wgpu::BackendType::Undefined};
+        wgpu::AdapterType adapterType{wgpu::AdapterType::Unknown};
+        // How to get this adapter again
+        wgpu::PowerPreference powerPreference{wgpu::PowerPreference::Undefined};
+        bool fallback{false};
+        bool timestampQuery{false};
+        bool shaderF16{false};
+        bool indirectFirstInstance{false};
+        uint32_t maxTextureDimension2D{};
+        uint64_t maxBufferSize{};
+        uint64_t maxStorageBufferBindingSize{};
+        uint32_t maxComputeInvocationsPerWorkgroup{};
+        double score{};
+    };
+
+    struct Options
+    {
+        // Only the CPU fallback adapter, for headless runs and --fallback-adapter
+        bool fallbackOnly{false};
+        // Empty disables the cache
+        std::filesystem::path cachePath;
+        // Enumerate even when the cache has a favorite
+        bool rescan{false};
+        double timeoutSeconds{10.0};
+    };
+
+    // The best adapter allowed by the options, nullptr when there is none
+    wgpu::Adapter Select(wgpu::Instance instance, wgpu::Surface surface, const Options& options);
+
+    const std::vector<Candidate>& GetCandidates() const { return m_Candidates; }
+    bool UsedCache() const { return m_UsedCache; }
+    void PrintReport(std::ostream& out) const;
+
+    static double Score(const Candidate& candidate);
+
+private:
+    wgpu::Adapter Request(wgpu::Instance instance, wgpu::Surface surface, wgpu::PowerPreference powerPreference,
+        wgpu::BackendType backendType, bool fallback, double timeoutSeconds) const;
+    static Candidate Inspect(wgpu::Adapter adapter);
+    // Highest score among the candidates the options allow, nullptr when none does
+    const Candidate* GetBest(const Options& options) const;
+    bool LoadCache(const std::filesystem::path& path);
+    bool SaveCache(const std::filesystem::path& path) const;
+
+    std::vector<Candidate> m_Candidates;
+    int m_SelectedIndex{-1};
+    bool m_UsedCache{false};
+};
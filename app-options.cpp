@@ -0,0 +1,225 @@
+#include "app-options.h"
+#include <charconv>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    bool ParseUint(std::string_view text, uint32_t& value)
+    {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc{} && end == text.data() + text.size();
+    }
+
+    bool ParseDouble(std::string_view text, double& value)
+    {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc{} && end == text.data() + text.size();
+    }
+}
+
+bool ParseAppOptions(int argc, char** argv, AppOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--gpu-driven")
+        {
+            options.gpuDriven = true;
+        }
+        else if (arg == "--objects" && hasValue)
+        {
+            if (!ParseUint(argv[++i], options.objectCount) || options.objectCount == 0)
+            {
+                std::cerr << "--objects expects a positive integer" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--fallback-adapter")
+        {
+            options.forceFallbackAdapter = true;
+        }
+        else if (arg == "--adapter-cache" && hasValue)
+        {
+            options.adapterCache = argv[++i];
+        }
+        else if (arg == "--rescan-adapters")
+        {
+            options.rescanAdapters = true;
+        }
+        else if (arg == "--frames-in-flight" && hasValue)
+        {
+            if (!ParseUint(argv[++i], options.framesInFlight) || options.framesInFlight == 0)
+            {
+                std::cerr << "--frames-in-flight expects a positive integer" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if (arg == "--frames" && hasValue)
+        {
+            if (!ParseUint(argv[++i], options.frameCount) || options.frameCount == 0)
+            {
+                std::cerr << "--frames expects a positive integer" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--capture-dir" && hasValue)
+        {
+            options.captureDirectory = argv[++i];
+        }
+        else if (arg == "--capture-interval" && hasValue)
+        {
+            if (!ParseUint(argv[++i], options.captureInterval) || options.captureInterval == 0)
+            {
+                std::cerr << "--capture-interval expects a positive integer" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--capture-video" && hasValue)
+        {
+            options.captureVideo = argv[++i];
+        }
+        else if (arg == "--capture-format" && hasValue)
+        {
+            const std::string_view format = argv[++i];
+            if (format != "bgra" && format != "y4m")
+            {
+                std::cerr << "--capture-format expects bgra or y4m" << std::endl;
+                return false;
+            }
+            options.captureY4m = format == "y4m";
+        }
+        else if (arg == "--capture-buffers" && hasValue)
+        {
+            if (!ParseUint(argv[++i], options.captureBuffers) || options.captureBuffers == 0)
+            {
+                std::cerr << "--capture-buffers expects a positive integer" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--gpu-profile")
+        {
+            options.gpuProfile = true;
+        }
+        else if (arg == "--trace" && hasValue)
+        {
+            options.tracePath = argv[++i];
+        }
+        else if (arg == "--no-overlay")
+        {
+            options.overlay = false;
+        }
+        else if (arg == "--present-mode" && hasValue)
+        {
+            options.presentMode = argv[++i];
+            if (options.presentMode != "fifo" && options.presentMode != "mailbox" && options.presentMode != "immediate")
+            {
+                std::cerr << "--present-mode expects fifo, mailbox or immediate" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--fps-cap" && hasValue)
+        {
+            if (!ParseDouble(argv[++i], options.fpsCap) || options.fpsCap <= 0.0)
+            {
+                std::cerr << "--fps-cap expects a positive number of frames per second" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--msaa" && hasValue)
+        {
+            if (!ParseUint(argv[++i], options.sampleCount) || (options.sampleCount != 1 && options.sampleCount != 4))
+            {
+                std::cerr << "--msaa expects 1 or 4" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--draws" && hasValue)
+        {
+            if (!ParseUint(argv[++i], options.drawCount) || options.drawCount == 0)
+            {
+                std::cerr << "--draws expects a positive integer" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--pipelines" && hasValue)
+        {
+            if (!ParseUint(argv[++i], options.pipelineCount) || options.pipelineCount == 0)
+            {
+                std::cerr << "--pipelines expects a positive integer" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--grid" && hasValue)
+        {
+            if (!ParseUint(argv[++i], options.gridResolution) || options.gridResolution == 0 || options.gridResolution > 255)
+            {
+                std::cerr << "--grid expects an integer between 1 and 255" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--fixed-timestep" && hasValue)
+        {
+            if (!ParseDouble(argv[++i], options.fixedTimestep) || options.fixedTimestep <= 0.0)
+            {
+                std::cerr << "--fixed-timestep expects a positive number of seconds" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--warmup" && hasValue)
+        {
+            if (!ParseUint(argv[++i], options.warmupFrames))
+            {
+                std::cerr << "--warmup expects an integer" << std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (!options.captureDirectory.empty() && !options.captureVideo.empty())
+    {
+        std::cerr << "--capture-dir and --capture-video cannot be combined" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PrintAppUsage(const char* executable)
+{
+    std::cout << "Usage: " << executable << " [options]\n"
+              << "  --gpu-driven            Frustum cull on the GPU and draw with drawIndexedIndirect\n"
+              << "  --objects <n>           Number of objects in the GPU-driven scene (default 4096)\n"
+              << "  --fallback-adapter      Use the CPU fallback adapter (SwiftShader on Dawn)\n"
+              << "  --adapter-cache <file>  Adapter report to start from (default adapter-cache.json, \"\" disables)\n"
+              << "  --rescan-adapters       Enumerate and score the adapters again, then update the cache\n"
+              << "  --frames-in-flight <n>  Frames the CPU may run ahead of the GPU (default 2)\n"
+              << "  --headless              Render offscreen on the fallback adapter, no window\n"
+              << "  --frames <n>            Frames to render in headless mode (default 600)\n"
+              << "  --capture-dir <dir>     Read frames back and write them as PNGs into <dir>\n"
+              << "  --capture-interval <n>  Capture every Nth frame (default 60)\n"
+              << "  --capture-video <path>  Stream the captured frames into one file or named pipe\n"
+              << "  --capture-format <f>    bgra (raw, default) or y4m\n"
+              << "  --capture-buffers <n>   Extra readback buffers before frames get dropped (default 2)\n"
+              << "  --gpu-profile           Time the passes with GPU timestamp queries when supported\n"
+              << "  --trace <file>          Write a Chrome trace of the CPU zones (open it in Perfetto)\n"
+              << "  --no-overlay            Hide the frame-time graph\n"
+              << "  --present-mode <m>      fifo (default), mailbox or immediate, P cycles them at runtime\n"
+              << "  --fps-cap <n>           Hold the window to n frames per second\n"
+              << "  --msaa <n>              Samples per pixel, 1 (default) or 4\n"
+              << "  --draws <n>             Draw calls per frame, each with its own uniforms (default 2)\n"
+              << "  --pipelines <n>         Distinct pipelines the draws cycle through (default 1)\n"
+              << "  --grid <n>              Draw an NxN quad grid instead of the logo (n <= 255)\n"
+              << "  --fixed-timestep <s>    Advance the animation by s seconds per frame\n"
+              << "  --warmup <n>            Headless frames to render before measuring (default 0)\n";
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct AppOptions
+{
+    // Cull and draw the objects on the GPU with a single indirect draw.
+    bool gpuDriven{false};
+    uint32_t objectCount{4096};
+    // Ask for Dawn's CPU (SwiftShader) adapter so everything can run without a GPU.
+    bool forceFallbackAdapter{false};
+    // Scored adapter report of an earlier launch, empty to enumerate every time without caching
+    std::string adapterCache{"adapter-cache.json"};
+    // Enumerate and score the adapters again even when the cache has a favorite
+    bool rescanAdapters{false};
+    // How many frames the CPU may record before it waits for the GPU
+    uint32_t framesInFlight{2};
+    // Render a fixed number of frames into an offscreen texture, without GLFW or a surface
+    bool headless{false};
+    uint32_t frameCount{600};
+    // Read every Nth frame back from the GPU and write it as a PNG into this directory
+    std::string captureDirectory;
+    uint32_t captureInterval{60};
+    // Or append the frames to one raw BGRA / Y4M stream
+    std::string captureVideo;
+    bool captureY4m{false};
+    // Readback buffers on top of the frames in flight, a writer that falls further behind drops frames
+    uint32_t captureBuffers{2};
+    // Time every pass on the GPU with timestamp queries when the adapter supports them
+    bool gpuProfile{false};
+    // Record CPU zones and write them as a Chrome trace when the app exits
+    std::string tracePath;
+    // Frame-time graph on top of the scene in windowed mode
+    bool overlay{true};
+    // fifo, mailbox or immediate, fifo when the backend cannot present in the requested mode
+    std::string presentMode{"fifo"};
+    // Frames per second the windowed loop is held to, 0 for no cap
+    double fpsCap{0.0};
+    // 1 or 4, WebGPU has no other sample counts. With 4 the pass resolves into the target.
+    uint32_t sampleCount{1};
+
+    // Scene knobs of the benchmark presets
+    // Draws per frame with the CPU path, each with its own uniform slice
+    uint32_t drawCount{2};
+    // Distinct pipelines the draws cycle through
+    uint32_t pipelineCount{1};
+    // Replace the logo by a grid of NxN quads, 0 keeps the logo
+    uint32_t gridResolution{0};
+    // Advance the animation by this many seconds per frame instead of following the clock
+    double fixedTimestep{0.0};
+    // Headless frames rendered before the measurement starts
+    uint32_t warmupFrames{0};
+    // Frames the statistics keep
+    size_t statsWindow{240};
+};
+
+bool ParseAppOptions(int argc, char** argv, AppOptions& options);
+void PrintAppUsage(const char* executable);
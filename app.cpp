@@ -0,0 +1,1279 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <GLFW/glfw3.h>
+#define WEBGPU_CPP_IMPLEMENTATION
+#include <array>
+#include <webgpu/webgpu.hpp>
+#include <glfw3webgpu.h>
+#include "app.h"
+#include "gpu-driven.h"
+#include "frame-context.h"
+#include "frame-readback.h"
+#include "frame-writers.h"
+#include "gpu-profiler.h"
+#include "cpu-profiler.h"
+#include "frame-stats.h"
+#include "perf-overlay.h"
+#include "gpu-tracker.h"
+#include "gpu-handle.h"
+#include "mesh-pool.h"
+#include "staging-belt.h"
+#include "asset-loader.h"
+#include "device-requirements.h"
+#include "task-graph.h"
+#include "webgpu-utils.h"
+#include "adapter-selector.h"
+#include "frame-pacer.h"
+#include "draw-sorter.h"
+#include "frame-graph.h"
+#include "transient-pool.h"
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#endif
+
+using namespace wgpu;
+namespace fs = std::filesystem;
+
+// The owners below are reset by hand at the end of RunApp, before the device is released
+GpuHandle<SwapChain> swapChain;
+Surface windowSurface = nullptr;
+// Framebuffer size reported by GLFW, applied at the start of the next frame so a drag that
+// fires many callbacks still rebuilds the swapchain at most once per frame
+uint32_t pendingWidth = 0;
+uint32_t pendingHeight = 0;
+bool resizePending = false;
+// Picked from the modes the backend supports, P cycles through them at runtime
+std::vector<PresentMode> supportedPresentModes;
+PresentMode presentMode = PresentMode::Fifo;
+FramePacer framePacer;
+// Headless runs render into this texture instead of the swapchain
+GpuHandle<Texture> offscreenTexture;
+GpuHandle<TextureView> offscreenView;
+// The passes of a frame and their transient targets. The scene draws test and write a depth buffer
+// of the target size. With MSAA they render into a multisampled color target that is resolved into
+// the target view. Both are discarded at the end of the pass, and memoryless where the device has
+// transient attachments.
+TransientPool transientPool;
+FrameGraph frameGraph;
+constexpr TextureFormat DepthFormat = TextureFormat::Depth24Plus;
+uint32_t sampleCount = 1;
+bool transientAttachments = false;
+uint32_t targetWidth = 640;
+uint32_t targetHeight = 480;
+Device device = nullptr;
+Queue queue = nullptr;
+// Every mesh of the scene lives in the pool, the CPU path draws the scene mesh once it is loaded
+MeshPool meshPool;
+AssetLoader assetLoader;
+AssetLoader::Handle sceneAsset;
+// Every upload after startup goes through the belt and into the frame's command encoder
+StagingBelt stagingBelt;
+// One pipeline per variant, the draws cycle through them. The opaque draws write depth, the
+// translucent ones only test against it.
+std::vector<GpuHandle<RenderPipeline>> pipelines;
+std::vector<GpuHandle<RenderPipeline>> translucentPipelines;
+DrawSorter drawSorter;
+GpuHandle<BindGroup> bindGroup;
+GpuHandle<Buffer> uniformBuffer;
+uint32_t uniformStride = 0;
+// Each frame in flight gets its own slice of the uniform buffer with one entry per draw
+uint32_t drawsPerFrame = 2;
+
+struct MyUniforms {
+    std::array<float, 4> color;  // or float color[4]
+    float time;
+    // Width over height of the target, the shader keeps the logo undistorted with it
+    float aspectRatio;
+    // Clip-space z of the whole draw, later draws are nearer
+    float depth;
+    float _pad[1];
+};
+MyUniforms uniforms;
+// Takes the uniform slices of a frame the belt had no space for, they go through queue.writeBuffer
+std::vector<uint8_t> uniformFallback;
+
+// WGSL sources, read from disk while the device is being requested
+struct ShaderSources
+{
+    std::string scene;
+    std::string cull;
+    std::string instanced;
+    std::string overlay;
+};
+
+AppOptions appOptions;
+GpuDrivenRenderer gpuDriven;
+FrameContextManager frameContexts;
+FrameReadback frameReadback;
+std::unique_ptr<FrameWriter> frameWriter;
+GpuProfiler gpuProfiler;
+FrameStats frameStats;
+PerfOverlay perfOverlay;
+bool overlayVisible = false;
+
+uint64_t animationFrame = 0;
+
+void Render();
+void CreateSwapChain();
+bool ApplyPendingResize();
+double GetTime();
+float GetDrawDepth(uint32_t draw);
+double GetAnimationTime();
+TextureView AcquireTargetView();
+void Shutdown(Instance instance, Adapter adapter, GLFWwindow* glfwWindow);
+
+int RunApp(const AppOptions& options, RunResult* result)
+{
+    std::cout << "LOG FOR ME!!!" << std::endl;
+    const auto runStart = std::chrono::steady_clock::now();
+    static_assert(sizeof(MyUniforms) % 16 == 0);
+
+    // Start from a clean slate, RunApp can be called several times in one process
+    appOptions = options;
+    drawsPerFrame = std::max(options.drawCount, 1u);
+    animationFrame = 0;
+    frameContexts = FrameContextManager{};
+    gpuProfiler = GpuProfiler{};
+    frameStats = FrameStats{options.statsWindow};
+    overlayVisible = false;
+    targetWidth = 640;
+    targetHeight = 480;
+    resizePending = false;
+    sampleCount = options.sampleCount;
+    transientAttachments = false;
+    presentMode = PresentMode::Fifo;
+    supportedPresentModes = { PresentMode::Fifo };
+
+    // The geometry decodes on a worker while the device and the pipelines are set up
+    assetLoader.Start();
+    sceneAsset = assetLoader.LoadMesh("scene", [resolution = options.gridResolution](std::vector<float>& pointData, std::vector<uint16_t>& indexData)
+    {
+        return resolution > 0
+            ? GenerateGridGeometry(resolution, pointData, indexData)
+            : LoadGeometry(RESOURCE_DIR "/webgpu.txt", pointData, indexData);
+    });
+
+    #ifdef __EMSCRIPTEN__
+	Instance instance = wgpuCreateInstance(nullptr);
+    #else
+	Instance instance = createInstance(InstanceDescriptor{});
+    #endif
+
+    if(!instance)
+    {
+        std::cerr << "Could not initialize WebGPU!" << std::endl;
+        Shutdown(instance, nullptr, nullptr);
+        return 1;
+    }
+    
+    // Room for the largest grid on top of the default capacity of the mesh pool
+    const uint32_t gridSide = appOptions.gridResolution + 1;
+    const uint32_t meshPoolVertices = std::max(1u << 16, gridSide * gridSide);
+    const uint32_t meshPoolIndices = std::max(1u << 18, appOptions.gridResolution * appOptions.gridResolution * 6);
+
+    // A GPU process that never answers should end the run instead of hanging it
+    constexpr double RequestTimeoutSeconds = 10.0;
+
+    // Startup runs as a task graph. The shader sources are read on a worker while the window, the
+    // adapter and the device come up one after the other on this thread, and the geometry is already
+    // decoding in the asset loader.
+    GLFWwindow* glfwWindow = nullptr;
+    Adapter adapter = nullptr;
+    SupportedLimits supportedLimits = Default;
+    bool timestampsSupported = false;
+    ShaderSources shaderSources;
+    TaskGraph startup;
+    startup.Add("Read shaders", [&]
+    {
+        if (!LoadShaderSource(RESOURCE_DIR "/shader.wgsl", shaderSources.scene))
+        {
+            std::cerr << "Could not read the shader!" << std::endl;
+            return false;
+        }
+        // The optional passes notice a missing source when they create their pipelines
+        if (appOptions.gpuDriven)
+        {
+            LoadShaderSource(RESOURCE_DIR "/cull.wgsl", shaderSources.cull);
+            LoadShaderSource(RESOURCE_DIR "/instanced.wgsl", shaderSources.instanced);
+        }
+        if (appOptions.overlay && !appOptions.headless)
+        {
+            LoadShaderSource(RESOURCE_DIR "/overlay.wgsl", shaderSources.overlay);
+        }
+        return true;
+    });
+    // Headless runs never touch GLFW, there may be no display to open a window on
+    const TaskGraph::TaskId windowTask = startup.Add("Create window", [&]
+    {
+        if (appOptions.headless)
+        {
+            return true;
+        }
+        if (!glfwInit()) {
+            std::cerr << "Could not initialize GLFW!" << std::endl;
+            return false;
+        }
+
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        // Captured frames all have the size of the first one, the video formats cannot change it midway
+        const bool capturing = !appOptions.captureDirectory.empty() || !appOptions.captureVideo.empty();
+        glfwWindowHint(GLFW_RESIZABLE, capturing ? GLFW_FALSE : GLFW_TRUE);
+        glfwWindow = glfwCreateWindow(static_cast<int>(targetWidth), static_cast<int>(targetHeight), "Learn WebGPU!!!", nullptr, nullptr);
+        if(!glfwWindow)
+        {
+            std::cerr << "Could not open window!" << std::endl;
+            return false;
+        }
+        windowSurface = glfwGetWGPUSurface(instance, glfwWindow);
+
+        // The framebuffer is larger than the window on high-DPI screens
+        int framebufferWidth = 0;
+        int framebufferHeight = 0;
+        glfwGetFramebufferSize(glfwWindow, &framebufferWidth, &framebufferHeight);
+        if (framebufferWidth > 0 && framebufferHeight > 0)
+        {
+            targetWidth = static_cast<uint32_t>(framebufferWidth);
+            targetHeight = static_cast<uint32_t>(framebufferHeight);
+        }
+        resizePending = false;
+        glfwSetFramebufferSizeCallback(glfwWindow, [](GLFWwindow*, int width, int height)
+        {
+            pendingWidth = static_cast<uint32_t>(std::max(width, 0));
+            pendingHeight = static_cast<uint32_t>(std::max(height, 0));
+            resizePending = true;
+        });
+        glfwSetKeyCallback(glfwWindow, [](GLFWwindow*, int key, int, int action, int)
+        {
+            if (key == GLFW_KEY_P && action == GLFW_PRESS && supportedPresentModes.size() > 1)
+            {
+                auto current = std::find(supportedPresentModes.begin(), supportedPresentModes.end(), presentMode);
+                presentMode = current + 1 < supportedPresentModes.end() ? *(current + 1) : supportedPresentModes.front();
+                std::cout << "Present mode " << GetPresentModeName(presentMode) << std::endl;
+                // Rebuilt at the start of the next frame, the same way as after a resize
+                pendingWidth = targetWidth;
+                pendingHeight = targetHeight;
+                resizePending = true;
+            }
+        });
+        return true;
+    }, {}, TaskGraph::Affinity::Main);
+    const TaskGraph::TaskId adapterTask = startup.Add("Request adapter", [&]
+    {
+        // A cached favorite is requested directly, otherwise every adapter is scored and the report cached
+        std::cout << "Selecting adapter..." << std::endl;
+        const auto selectStart = std::chrono::steady_clock::now();
+        AdapterSelector adapterSelector;
+        adapter = adapterSelector.Select(instance, windowSurface,
+        {
+            .fallbackOnly = appOptions.forceFallbackAdapter || appOptions.headless,
+            .cachePath = appOptions.adapterCache,
+            .rescan = appOptions.rescanAdapters,
+            .timeoutSeconds = RequestTimeoutSeconds,
+        });
+        adapterSelector.PrintReport(std::cout);
+        if (!adapter)
+        {
+            std::cerr << "Could not get an adapter!" << std::endl;
+            return false;
+        }
+        std::cout << "Picked adapter " << describeAdapter(adapter) << " in "
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - selectStart).count() << " ms" << std::endl;
+
+        AdapterProperties adapterProperties = Default;
+        adapter.getProperties(&adapterProperties);
+        if (result)
+        {
+            result->adapterName = adapterProperties.name ? adapterProperties.name : "";
+        }
+        if (!appOptions.headless)
+        {
+            supportedPresentModes = GetSupportedPresentModes(adapterProperties.backendType);
+            PresentMode requested = PresentMode::Fifo;
+            ParsePresentMode(appOptions.presentMode, requested);
+            if (std::find(supportedPresentModes.begin(), supportedPresentModes.end(), requested) != supportedPresentModes.end())
+            {
+                presentMode = requested;
+            }
+            else
+            {
+                std::cout << "Present mode " << appOptions.presentMode << " is not supported here, using fifo" << std::endl;
+            }
+        }
+        return true;
+    }, appOptions.headless ? std::vector<TaskGraph::TaskId>{} : std::vector{ windowTask }, TaskGraph::Affinity::Main);
+    startup.Add("Request device", [&]
+    {
+        // The limits follow from the scene, the adapter only has to offer at least that much
+        DeviceRequirements requirements(adapter);
+        supportedLimits = requirements.GetSupportedLimits();
+        // Position and color from one interleaved buffer, the color is passed on to the fragment stage
+        requirements.Require(&Limits::maxVertexAttributes, 2, "maxVertexAttributes");
+        requirements.Require(&Limits::maxVertexBuffers, 1, "maxVertexBuffers");
+        requirements.Require(&Limits::maxVertexBufferArrayStride, MeshPool::VertexStride, "maxVertexBufferArrayStride");
+        requirements.Require(&Limits::maxInterStageShaderComponents, 3, "maxInterStageShaderComponents");
+        requirements.Require(&Limits::maxBindGroups, 1, "maxBindGroups");
+        requirements.Require(&Limits::maxUniformBuffersPerShaderStage, 1, "maxUniformBuffersPerShaderStage");
+        requirements.Require(&Limits::maxUniformBufferBindingSize, sizeof(MyUniforms), "maxUniformBufferBindingSize");
+        requirements.Require(&Limits::maxDynamicUniformBuffersPerPipelineLayout, 1, "maxDynamicUniformBuffersPerPipelineLayout");
+        // Windows can be resized up to whatever the adapter supports, offscreen targets keep their size
+        if (appOptions.headless)
+        {
+            requirements.Require(&Limits::maxTextureDimension2D, std::max(targetWidth, targetHeight), "maxTextureDimension2D");
+        }
+        else
+        {
+            requirements.RequireSupported(&Limits::maxTextureDimension2D, "maxTextureDimension2D");
+        }
+        requirements.Require(&Limits::maxBufferSize, MeshPool::GetLargestBufferSize(meshPoolVertices, meshPoolIndices), "maxBufferSize");
+        // One uniform slice per draw and frame in flight, at the worst-case 256 byte alignment
+        requirements.Require(&Limits::maxBufferSize, static_cast<uint64_t>(FrameContextManager::MaxFramesInFlight) * drawsPerFrame * 256, "maxBufferSize");
+        if (appOptions.gpuDriven)
+        {
+            // Object list, compacted visible list and indirect arguments of the culling pass
+            const uint64_t largestBuffer = GpuDrivenRenderer::GetLargestBufferSize(appOptions.objectCount);
+            requirements.Require(&Limits::maxBufferSize, largestBuffer, "maxBufferSize");
+            requirements.Require(&Limits::maxStorageBufferBindingSize, largestBuffer, "maxStorageBufferBindingSize");
+            requirements.Require(&Limits::maxStorageBuffersPerShaderStage, 3, "maxStorageBuffersPerShaderStage");
+            requirements.Require(&Limits::maxUniformBufferBindingSize, GpuDrivenRenderer::GetUniformBufferSize(), "maxUniformBufferBindingSize");
+            requirements.Require(&Limits::maxComputeWorkgroupSizeX, GpuDrivenRenderer::WorkgroupSize, "maxComputeWorkgroupSizeX");
+            requirements.Require(&Limits::maxComputeInvocationsPerWorkgroup, GpuDrivenRenderer::WorkgroupSize, "maxComputeInvocationsPerWorkgroup");
+            requirements.Require(&Limits::maxComputeWorkgroupsPerDimension,
+                (appOptions.objectCount + GpuDrivenRenderer::WorkgroupSize - 1) / GpuDrivenRenderer::WorkgroupSize, "maxComputeWorkgroupsPerDimension");
+        }
+        if (!requirements.Validate(std::cerr))
+        {
+            std::cerr << "The adapter cannot run this scene, try fewer objects or a smaller grid" << std::endl;
+            return false;
+        }
+
+        // Optional features, each with a fallback. Without timestamps the profiler stays disabled. The
+        // shaders are plain f32 and the culling pass writes firstInstance 0, so shader-f16 and
+        // indirect-first-instance are only taken where the adapter has them for free.
+        timestampsSupported = appOptions.gpuProfile && requirements.RequestFeature(FeatureName::TimestampQuery);
+#ifdef WEBGPU_BACKEND_DAWN
+        // Depth and MSAA color never leave tile memory on the GPUs that have it
+        transientAttachments = requirements.RequestFeature(FeatureName::TransientAttachments);
+#endif
+        requirements.RequestFeature(FeatureName::ShaderF16);
+        if (appOptions.gpuDriven)
+        {
+            requirements.RequestFeature(FeatureName::IndirectFirstInstance);
+        }
+        requirements.PrintSummary(std::cout);
+
+        const std::vector<FeatureName>& requiredFeatures = requirements.GetFeatures();
+        DeviceDescriptor deviceDescriptor
+        {{
+            .nextInChain = nullptr,
+            .label = "My Device",
+            .requiredFeatureCount = requiredFeatures.size(),
+            .requiredFeatures = reinterpret_cast<const WGPUFeatureName*>(requiredFeatures.data()),
+            .requiredLimits = &requirements.GetRequiredLimits(),
+        }};
+        auto deviceRequest = requestDeviceAsync(adapter, &deviceDescriptor);
+        if (!waitForRequest(instance, *deviceRequest, RequestTimeoutSeconds) || !deviceRequest->result)
+        {
+            std::cerr << "Could not get a device!" << std::endl;
+            return false;
+        }
+        device = deviceRequest->result;
+
+        device.setUncapturedErrorCallback([](const ErrorType type, char const* message) {
+            std::cout << "Uncaptured device error: type " << type << std::endl;
+            if (message) std::cout << " (" << message << ")";
+            std::cout << std::endl;
+        });
+        auto onDeviceLost = [](WGPUDeviceLostReason reason, char const * message, void * userdata)
+        {
+            std::cout << message << std::endl;
+        };
+        wgpuDeviceSetDeviceLostCallback(device, onDeviceLost, nullptr);
+        return true;
+    }, { adapterTask }, TaskGraph::Affinity::Main);
+    const bool started = startup.Run();
+    startup.PrintTimeline(std::cout);
+    if (!started)
+    {
+        Shutdown(instance, adapter, glfwWindow);
+        return 1;
+    }
+
+    queue = device.getQueue();
+    frameContexts.Init(device, queue, appOptions.framesInFlight);
+    transientPool.Init(device, frameContexts);
+    frameGraph.Init(transientPool);
+    if (appOptions.gpuProfile)
+    {
+        gpuProfiler.Init(device, timestampsSupported, frameContexts.GetFramesInFlight() + 2);
+    }
+
+    if (appOptions.headless)
+    {
+        std::cout << "Creating offscreen target..." << std::endl;
+        offscreenTexture = GpuHandle{GpuTracker::CreateTexture(device, TextureDescriptor
+        {{
+            .label = "Offscreen Target",
+            .usage = TextureUsage::RenderAttachment | TextureUsage::CopySrc,
+            .dimension = TextureDimension::_2D,
+            .size = {targetWidth, targetHeight, 1},
+            .format = TextureFormat::BGRA8Unorm,
+            .mipLevelCount = 1,
+            .sampleCount = 1,
+            .viewFormatCount = 0,
+            .viewFormats = nullptr,
+        }}, GpuTracker::Category::RenderTarget)};
+        offscreenView = GpuHandle{TextureView{wgpuTextureCreateView(offscreenTexture.Get(), nullptr)}};
+        std::cout << "Offscreen target: " << offscreenTexture.Get() << std::endl;
+    }
+    else
+    {
+        std::cout << "Creating swapchain..." << std::endl;
+        CreateSwapChain();
+        std::cout << "Swapchain: " << swapChain.Get() << std::endl;
+    }
+
+    ShaderModule shaderModule = CreateShaderModule(shaderSources.scene, device);
+    std::cout << "Shader module: " << shaderModule << std::endl;
+
+    std::vector vertexAttributes{
+        VertexAttribute
+        {{
+            .format = VertexFormat::Float32x2,
+            .offset = 0,
+            .shaderLocation = 0,
+        }},
+        VertexAttribute
+        {{
+            .format = VertexFormat::Float32x3,
+            .offset = 2 * sizeof(float),
+            .shaderLocation = 1
+        }}
+    };
+
+
+    VertexBufferLayout vertexBufferLayout
+	{{
+        .arrayStride = 5 * sizeof(float),
+        .stepMode = VertexStepMode::Vertex,
+        .attributeCount = static_cast<uint32_t>(vertexAttributes.size()),
+        .attributes = vertexAttributes.data(),
+	}};
+
+    BlendState blendState
+    {{
+        .color = {BlendComponent{{BlendOperation::Add,  BlendFactor::SrcAlpha, BlendFactor::OneMinusSrcAlpha}}},
+        .alpha = {BlendComponent{{BlendOperation::Add, BlendFactor::One, BlendFactor::Zero}}}
+    }};
+    ColorTargetState colorTarget
+    {{
+        .format = TextureFormat::BGRA8Unorm,
+        .blend = &blendState,
+        .writeMask = ColorWriteMask::All
+    }};
+
+    // Every variant overrides the shader constant, otherwise the device would dedupe identical pipelines
+    ConstantEntry brightnessConstant = Default;
+    brightnessConstant.key = "brightness";
+    FragmentState fragmentState
+    {{
+        .module = shaderModule,
+        .entryPoint = "fs_main",
+        .constantCount = 1,
+        .constants = &brightnessConstant,
+        .targetCount = 1,
+        .targets = &colorTarget
+    }};
+
+
+
+    // Binding group
+    BindGroupLayoutEntry bindingLayout = Default;
+    bindingLayout.binding = 0;
+    bindingLayout.visibility = ShaderStage::Vertex | ShaderStage::Fragment;
+    bindingLayout.buffer.type = BufferBindingType::Uniform;
+    bindingLayout.buffer.minBindingSize = sizeof(MyUniforms);
+    bindingLayout.buffer.hasDynamicOffset = true;
+
+    BindGroupLayoutDescriptor bindGroupLayoutDesc;
+    bindGroupLayoutDesc.entryCount = 1;
+    bindGroupLayoutDesc.entries = &bindingLayout;
+    BindGroupLayout bindGroupLayout = device.createBindGroupLayout(bindGroupLayoutDesc);
+
+    PipelineLayoutDescriptor layoutDesc;
+    layoutDesc.bindGroupLayoutCount = 1;
+    layoutDesc.bindGroupLayouts = (WGPUBindGroupLayout*)&bindGroupLayout;
+    PipelineLayout pipelineLayout = device.createPipelineLayout(layoutDesc);
+
+    // The nearest fragment wins, GetDrawDepth() keeps the look of drawing in submission order
+    DepthStencilState depthStencilState = Default;
+    depthStencilState.format = DepthFormat;
+    depthStencilState.depthWriteEnabled = true;
+    depthStencilState.depthCompare = CompareFunction::Less;
+    // Depth24Plus has no stencil aspect
+    depthStencilState.stencilReadMask = 0;
+    depthStencilState.stencilWriteMask = 0;
+    
+    RenderPipelineDescriptor pipelineDesc
+    {{
+        .label = "PipeLine",
+        .layout = pipelineLayout,
+        .vertex = VertexState
+        {{
+            .module = shaderModule,
+            .entryPoint = "vs_main",
+            .constantCount = 0,
+            .constants = nullptr,
+            .bufferCount = 1,
+            .buffers = &vertexBufferLayout,
+        }},
+        .primitive = PrimitiveState
+        {{
+            .topology = PrimitiveTopology::TriangleList,
+            .stripIndexFormat = IndexFormat::Undefined,
+            .frontFace = FrontFace::CCW,
+            .cullMode = CullMode::None
+        }},
+        
+        .depthStencil = &depthStencilState,
+        .multisample = MultisampleState{{.count = sampleCount, .mask = ~0u, .alphaToCoverageEnabled = false}},
+        .fragment = &fragmentState,
+    }};
+    
+    pipelines.clear();
+    translucentPipelines.clear();
+    for (uint32_t i = 0; i < std::max(appOptions.pipelineCount, 1u); ++i)
+    {
+        PROFILE_ZONE("CreateRenderPipeline");
+        brightnessConstant.value = 1.0 - 0.001 * i;
+        depthStencilState.depthWriteEnabled = true;
+        pipelines.emplace_back(GpuTracker::CreateRenderPipeline(device, pipelineDesc));
+        depthStencilState.depthWriteEnabled = false;
+        translucentPipelines.emplace_back(GpuTracker::CreateRenderPipeline(device, pipelineDesc));
+    }
+    pipelineLayout.release();
+    shaderModule.release();
+
+    stagingBelt.Init(device);
+    meshPool.Init(device, meshPoolVertices, meshPoolIndices);
+
+    // Uniform
+    
+    uniformStride = ceilToNextMultiple(
+        (uint32_t)sizeof(MyUniforms),
+        (uint32_t)supportedLimits.limits.minUniformBufferOffsetAlignment
+    );
+    
+    const uint32_t uniformSlices = frameContexts.GetFramesInFlight() * drawsPerFrame;
+    uniformBuffer = GpuHandle{GpuTracker::CreateBuffer(device, BufferDescriptor
+    {{
+        .label = "Uniform Buffer",
+        .usage = BufferUsage::CopyDst | BufferUsage::Uniform,
+        .size = (uniformSlices - 1) * uniformStride + sizeof(MyUniforms),
+        .mappedAtCreation = false,
+    }}, GpuTracker::Category::Uniform)};
+
+    BindGroupEntry binding;
+    binding.binding = 0;
+    binding.buffer = uniformBuffer.Get();
+    binding.offset = 0;
+    binding.size = sizeof(MyUniforms);
+
+    bindGroup = GpuHandle{GpuTracker::CreateBindGroup(device, BindGroupDescriptor 
+    {{
+        .label = "Uniform Bind Group",
+        .layout = bindGroupLayout,
+        .entryCount = 1,
+        .entries = &binding,
+    }})};
+    bindGroupLayout.release();
+
+    if (appOptions.gpuDriven)
+    {
+        // The culling setup is built around the mesh, this path waits for it and uploads it right away
+        assetLoader.WaitDecoded(sceneAsset);
+        GpuDrivenRenderer::Mesh mesh;
+        if (sceneAsset->GetState() == AssetLoader::State::Decoded)
+        {
+            mesh.bounds = GpuDrivenRenderer::ComputeMeshBounds(sceneAsset->GetPointData(), MeshPool::FloatsPerVertex);
+            GpuHandle<CommandEncoder> uploadEncoder{device.createCommandEncoder({{.label = "Upload Encoder"}})};
+            assetLoader.Pump(meshPool, stagingBelt, uploadEncoder);
+            stagingBelt.Finish();
+            GpuHandle<CommandBuffer> uploadCommands{uploadEncoder->finish(CommandBufferDescriptor{})};
+            queue.submit(1, &uploadCommands.Get());
+            stagingBelt.Recall();
+        }
+        if (!sceneAsset->IsReady()) {
+            std::cerr << "Could not load geometry!" << std::endl;
+            Shutdown(instance, adapter, glfwWindow);
+            return 1;
+        }
+
+        ShaderModule cullShader = CreateShaderModule(shaderSources.cull, device);
+        ShaderModule instancedShader = CreateShaderModule(shaderSources.instanced, device);
+
+        const MeshPool::Mesh& sceneMesh = sceneAsset->GetMesh();
+        mesh.vertexBuffer = meshPool.GetVertexBuffer();
+        mesh.vertexBufferSize = meshPool.GetVertexBufferSize();
+        mesh.indexBuffer = meshPool.GetIndexBuffer();
+        mesh.indexBufferSize = meshPool.GetIndexBufferSize();
+        mesh.indexCount = sceneMesh.indexCount;
+        mesh.firstIndex = sceneMesh.GetFirstIndex();
+        mesh.baseVertex = sceneMesh.GetBaseVertex();
+
+        const bool success = gpuDriven.Init(device, cullShader, instancedShader, TextureFormat::BGRA8Unorm, DepthFormat, sampleCount, mesh, appOptions.objectCount);
+        if (cullShader) cullShader.release();
+        if (instancedShader) instancedShader.release();
+        if (!success) {
+            std::cerr << "Could not create the GPU-driven pipelines!" << std::endl;
+            Shutdown(instance, adapter, glfwWindow);
+            return 1;
+        }
+        std::cout << "GPU-driven scene with " << gpuDriven.GetObjectCount() << " objects" << std::endl;
+    }
+
+    // The overlay would end up in captured frames, headless runs only report the numbers at exit
+    if (appOptions.overlay && !appOptions.headless)
+    {
+        ShaderModule overlayShader = CreateShaderModule(shaderSources.overlay, device);
+        overlayVisible = perfOverlay.Init(device, overlayShader, TextureFormat::BGRA8Unorm, DepthFormat, sampleCount);
+        if (overlayShader) overlayShader.release();
+    }
+
+    if (!appOptions.captureVideo.empty())
+    {
+        auto videoWriter = std::make_unique<RawVideoWriter>(appOptions.captureVideo,
+            appOptions.captureY4m ? RawVideoWriter::Format::Y4m : RawVideoWriter::Format::Bgra,
+            60, appOptions.captureInterval);
+        if (!videoWriter->IsOpen())
+        {
+            Shutdown(instance, adapter, glfwWindow);
+            return 1;
+        }
+        frameWriter = std::move(videoWriter);
+    }
+    else if (!appOptions.captureDirectory.empty())
+    {
+        frameWriter = std::make_unique<PngWriter>(appOptions.captureDirectory);
+    }
+
+    if (frameWriter)
+    {
+        frameWriter->Start();
+        // Map a readback buffer only once the frames in flight ahead of it had time to finish. The ring
+        // bounds the capture memory, a writer that falls behind makes frames drop instead of stalling Render()
+        frameReadback.Init(device, targetWidth, targetHeight, frameContexts.GetFramesInFlight() + appOptions.captureBuffers,
+            frameContexts.GetFramesInFlight(), [](const ReadbackFrame& frame) { frameWriter->Submit(frame); });
+    }
+
+    // Headless runs measure throughput, only the window is paced
+    framePacer = FramePacer{GetTime, appOptions.headless ? 0.0 : appOptions.fpsCap};
+    int exitCode = 0;
+#ifdef __EMSCRIPTEN__
+    emscripten_set_main_loop(Render, 0, false);
+#else
+
+    double loopStart = GetTime();
+    double lastTitleUpdate = loopStart;
+    uint32_t renderedFrames = 0;
+    uint32_t warmupFrames = appOptions.headless ? appOptions.warmupFrames : 0;
+    if (appOptions.headless)
+    {
+        // Captures and benchmarks want the scene from the first frame on, the first Render() uploads it
+        assetLoader.WaitDecoded(sceneAsset);
+    }
+    while (appOptions.headless ? renderedFrames < appOptions.frameCount : !glfwWindowShouldClose(glfwWindow))
+    {
+        if (sceneAsset->IsFailed())
+        {
+            std::cerr << "Could not load geometry!" << std::endl;
+            exitCode = 1;
+            break;
+        }
+        if (warmupFrames > 0 && renderedFrames == warmupFrames)
+        {
+            // Pipeline compilation and first-use costs are behind us, measure from here
+            frameContexts.WaitIdle();
+            frameStats = FrameStats{appOptions.statsWindow};
+            loopStart = GetTime();
+            renderedFrames = 0;
+            warmupFrames = 0;
+        }
+        if (!appOptions.headless && !ApplyPendingResize())
+        {
+            // Minimized, there is nothing to render into until the window comes back
+            glfwWaitEvents();
+            continue;
+        }
+        framePacer.WaitForNextFrame();
+        frameStats.BeginFrame(GetTime());
+        Render();
+        if (!appOptions.headless)
+        {
+            PROFILE_ZONE("SwapChain::present");
+            const double presentStart = GetTime();
+            swapChain->present();
+            frameStats.RecordPresentWait((GetTime() - presentStart) * 1000.0);
+            framePacer.MarkPresented(presentMode);
+
+            if (GetTime() - lastTitleUpdate > 0.5)
+            {
+                lastTitleUpdate = GetTime();
+                // Live GPU memory next to the timings, growth over a long session shows up here first
+                const std::string title = "Learn WebGPU!!! | " + frameStats.FormatSummary()
+                    + " | vram " + std::to_string(GpuTracker::GetLiveBytes() / 1048576) + " MB | "
+                    + GetPresentModeName(presentMode) + " " + std::to_string(static_cast<int>(framePacer.GetLatestLatencyMs(presentMode))) + " ms";
+                glfwSetWindowTitle(glfwWindow, title.c_str());
+            }
+        }
+#ifdef WEBGPU_BACKEND_DAWN
+        // Check for pending error callbacks
+        device.tick();
+#endif
+        if (animationFrame == 0)
+        {
+            // Everything from entering RunApp to the first submitted (and presented) frame
+            const double timeToFirstFrame = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+            std::cout << "Time to first frame: " << timeToFirstFrame << " ms, startup graph " << startup.GetElapsedMs() << " ms" << std::endl;
+            if (result)
+            {
+                result->timeToFirstFrameMs = timeToFirstFrame;
+            }
+        }
+        ++renderedFrames;
+        ++animationFrame;
+    }
+
+    frameContexts.WaitIdle();
+    // Draining the readbacks and joining the writer is capture I/O, not render time
+    const double loopSeconds = GetTime() - loopStart;
+    if (frameWriter)
+    {
+        frameReadback.Flush();
+        frameWriter->Stop();
+        std::cout << "Captured " << frameWriter->GetWrittenCount() << " frames to "
+                  << (appOptions.captureVideo.empty() ? appOptions.captureDirectory : appOptions.captureVideo)
+                  << ", dropped " << frameReadback.GetDroppedCount() << std::endl;
+        frameReadback.Release();
+        frameWriter.reset();
+    }
+    if (appOptions.headless && renderedFrames > 0)
+    {
+        std::cout << "Rendered " << renderedFrames << " headless frames in " << loopSeconds << " s ("
+                  << renderedFrames / loopSeconds << " frames/s, "
+                  << loopSeconds * 1000.0 / renderedFrames << " ms/frame)" << std::endl;
+    }
+    if (result)
+    {
+        result->frames = renderedFrames;
+        result->seconds = loopSeconds;
+        result->stats = frameStats;
+        result->sampleCount = sampleCount;
+        result->renderTargetBytes = GpuTracker::GetLiveBytes(GpuTracker::Category::RenderTarget);
+        // 4 bytes per color and per depth sample, plus the 4 byte resolve per pixel with MSAA
+        const uint64_t pixels = static_cast<uint64_t>(targetWidth) * targetHeight;
+        result->attachmentBytesPerFrame = pixels * sampleCount * 8 + (sampleCount > 1 ? pixels * 4 : 0);
+        result->transientHitRate = transientPool.GetHitRate();
+        result->transientCreatedLastFrame = transientPool.GetStats().createdLastFrame;
+    }
+    std::cout << "Frames in flight: " << frameContexts.GetFramesInFlight()
+              << ", CPU waited on the GPU " << frameContexts.GetAverageWaitMs() << " ms per frame on average"
+              << " (max " << frameContexts.GetMaxWaitMs() << " ms)" << std::endl;
+
+    frameStats.PrintReport(std::cout);
+    framePacer.PrintReport(std::cout);
+    frameGraph.PrintReport(std::cout);
+    transientPool.PrintReport(std::cout);
+    gpuProfiler.PrintReport(std::cout);
+    GpuTracker::PrintReport(std::cout);
+    meshPool.PrintReport(std::cout);
+    stagingBelt.PrintReport(std::cout);
+    Shutdown(instance, adapter, glfwWindow);
+#endif
+
+    return exitCode;
+}
+
+// Every exit of RunApp ends here, also the early ones. Bench runs several scenes in one process,
+// whatever a failed run left behind would show up as leaks of all the runs after it.
+void Shutdown(Instance instance, Adapter adapter, GLFWwindow* glfwWindow)
+{
+    frameContexts.WaitIdle();
+    if (frameWriter)
+    {
+        frameReadback.Flush();
+        frameWriter->Stop();
+        frameWriter.reset();
+    }
+    frameReadback.Release();
+    perfOverlay.Release();
+    gpuProfiler.Release();
+    gpuDriven.Release();
+    pipelines.clear();
+    translucentPipelines.clear();
+    bindGroup.Reset();
+    uniformBuffer.Reset();
+    assetLoader.Stop();
+    sceneAsset.reset();
+    meshPool.Release();
+    stagingBelt.Release();
+    offscreenView.Reset();
+    offscreenTexture.Reset();
+    frameGraph.Release();
+    transientPool.Release();
+    swapChain.Reset();
+
+    // Everything the app created should be gone by now, what is left would leak on every run
+    const size_t leaks = GpuTracker::ReportLeaks(std::cerr);
+    if (leaks > 0)
+    {
+        std::cerr << leaks << " GPU objects still alive at shutdown" << std::endl;
+    }
+
+    if (queue) queue.release();
+    queue = nullptr;
+    if (device) device.release();
+    device = nullptr;
+    if (adapter) adapter.release();
+    if (windowSurface) windowSurface.release();
+    windowSurface = nullptr;
+    if (instance) instance.release();
+
+    if (glfwWindow)
+    {
+        glfwDestroyWindow(glfwWindow);
+    }
+    if (!appOptions.headless)
+    {
+        // Also after glfwInit succeeded but the window could not be created
+        glfwTerminate();
+    }
+}
+
+void Render()
+{
+    PROFILE_FUNCTION();
+    const uint32_t firstSlice = frameContexts.BeginFrame() * drawsPerFrame;
+    // The per-frame objects are released when Render() returns
+    GpuHandle<TextureView> nextTexture{AcquireTargetView()};
+    // Input is sampled after everything that may block on the GPU or the swapchain, so the frame
+    // shows the newest state it can
+    if (!appOptions.headless)
+    {
+        PROFILE_ZONE("glfwPollEvents");
+        glfwPollEvents();
+        framePacer.MarkInputSampled();
+    }
+    const double encodeStart = GetTime();
+    gpuProfiler.BeginFrame();
+
+    GpuHandle<CommandEncoder> encoder{device.createCommandEncoder({{.label = "Command Encoder"}})};
+    assetLoader.Pump(meshPool, stagingBelt, encoder);
+
+    // The uniform slices of this frame are contiguous, one copy covers all of them
+    const float time = static_cast<float>(GetAnimationTime());
+    const uint64_t uniformBytes = static_cast<uint64_t>(drawsPerFrame - 1) * uniformStride + sizeof(MyUniforms);
+    auto* sliceData = static_cast<uint8_t*>(stagingBelt.Upload(encoder, uniformBuffer, firstSlice * uniformStride, uniformBytes));
+    // The belt counts the miss, drawing with the uniforms of an older frame would go unnoticed
+    const bool uniformsStaged = sliceData != nullptr;
+    if (!uniformsStaged)
+    {
+        uniformFallback.resize(uniformBytes);
+        sliceData = uniformFallback.data();
+    }
+    for (uint32_t draw = 0; draw < drawsPerFrame; ++draw)
+    {
+        // Even draws run forward in green, odd ones backward in translucent white, each pair a little further along
+        uniforms.color = draw % 2 == 0 ? std::array{ 0.0f, 1.0f, 0.4f, 1.0f } : std::array{ 1.0f, 1.0f, 1.0f, 0.7f };
+        uniforms.time = (draw % 2 == 0 ? time : -time) + 0.37f * static_cast<float>(draw / 2);
+        uniforms.aspectRatio = static_cast<float>(targetWidth) / static_cast<float>(targetHeight);
+        uniforms.depth = GetDrawDepth(draw);
+        std::memcpy(sliceData + draw * uniformStride, &uniforms, sizeof(MyUniforms));
+    }
+    if (!uniformsStaged)
+    {
+        queue.writeBuffer(uniformBuffer, firstSlice * uniformStride, sliceData, uniformBytes);
+    }
+
+    if (appOptions.gpuDriven)
+    {
+        gpuDriven.Update(stagingBelt, queue, encoder, time, static_cast<float>(targetWidth) / static_cast<float>(targetHeight));
+    }
+
+    // The depth buffer and the multisampled color only live for the scene pass, the graph keeps them
+    // from one frame to the next as long as the target size does not change
+    frameGraph.Reset();
+    const FrameGraph::ResourceId target = frameGraph.ImportTexture("Target", appOptions.headless ? offscreenTexture.Get() : Texture{nullptr}, nextTexture.Get());
+    const FrameGraph::ResourceId drawArgs = appOptions.gpuDriven ? frameGraph.ImportBuffer("Draw Arguments", gpuDriven.GetDrawArgsBuffer()) : FrameGraph::InvalidResource;
+    if (appOptions.gpuDriven)
+    {
+        frameGraph.AddPass("Cull Pass", [&](FrameGraph::PassBuilder& builder)
+        {
+            builder.Write(drawArgs);
+        }, [](const FrameGraph&, CommandEncoder passEncoder)
+        {
+            gpuDriven.EncodeCulling(passEncoder, gpuProfiler.BeginComputePass("Cull Pass"));
+        });
+    }
+
+    FrameGraph::ResourceId depth = FrameGraph::InvalidResource;
+    FrameGraph::ResourceId msaaColor = FrameGraph::InvalidResource;
+    frameGraph.AddPass("Render Pass", [&](FrameGraph::PassBuilder& builder)
+    {
+        WGPUTextureUsageFlags extraUsage = TextureUsage::None;
+#ifdef WEBGPU_BACKEND_DAWN
+        if (transientAttachments)
+        {
+            extraUsage = TextureUsage::TransientAttachment;
+        }
+#endif
+        depth = builder.Create({ "Depth Buffer", targetWidth, targetHeight, DepthFormat, sampleCount, extraUsage });
+        if (sampleCount > 1)
+        {
+            msaaColor = builder.Create({ "MSAA Color", targetWidth, targetHeight, TextureFormat::BGRA8Unorm, sampleCount, extraUsage });
+        }
+        builder.Write(target);
+        if (drawArgs != FrameGraph::InvalidResource)
+        {
+            builder.Read(drawArgs);
+        }
+    }, [&](const FrameGraph& graph, CommandEncoder passEncoder)
+    {
+        // The multisampled color is only needed until it is resolved
+        RenderPassColorAttachment attachment
+        {{
+            .view = sampleCount > 1 ? graph.GetView(msaaColor) : graph.GetView(target),
+            .resolveTarget = sampleCount > 1 ? graph.GetView(target) : nullptr,
+            .loadOp = LoadOp::Clear,
+            .storeOp = sampleCount > 1 ? StoreOp::Discard : StoreOp::Store,
+            .clearValue = Color{ 0.05, 0.05, 0.05, 1.0 },
+        }};
+        // Nothing reads the depth after the pass, tile-based GPUs never have to write it out
+        RenderPassDepthStencilAttachment depthAttachment
+        {{
+            .view = graph.GetView(depth),
+            .depthLoadOp = LoadOp::Clear,
+            .depthStoreOp = StoreOp::Discard,
+            .depthClearValue = 1.0f,
+            .depthReadOnly = false,
+            .stencilLoadOp = LoadOp::Undefined,
+            .stencilStoreOp = StoreOp::Undefined,
+            .stencilClearValue = 0,
+            .stencilReadOnly = true,
+        }};
+        GpuHandle<RenderPassEncoder> renderPass{passEncoder.beginRenderPass(RenderPassDescriptor
+        {{
+            .colorAttachmentCount = 1,
+            .colorAttachments = &attachment,
+            .depthStencilAttachment = &depthAttachment,
+            .timestampWrites = gpuProfiler.BeginRenderPass("Render Pass"),
+        }})};
+        if (appOptions.gpuDriven)
+        {
+            gpuDriven.Draw(renderPass);
+        }
+        else if (sceneAsset->IsReady())
+        {
+            meshPool.Bind(renderPass);
+
+            // Even draws are opaque, odd ones translucent
+            drawSorter.Clear();
+            for (uint32_t draw = 0; draw < drawsPerFrame; ++draw)
+            {
+                drawSorter.Add(draw, GetDrawDepth(draw), draw % 2 == 1);
+            }
+            drawSorter.Sort();
+            for (uint32_t draw : drawSorter.GetOrder())
+            {
+                const auto& variants = draw % 2 == 1 ? translucentPipelines : pipelines;
+                renderPass->setPipeline(variants[draw % variants.size()]);
+                uint32_t dynamicOffset = (firstSlice + draw) * uniformStride;
+                renderPass->setBindGroup(0, bindGroup, 1, &dynamicOffset);
+                meshPool.Draw(renderPass, sceneAsset->GetMesh());
+            }
+        }
+
+        if (overlayVisible)
+        {
+            perfOverlay.Update(queue, frameStats.GetFrameTimes());
+            perfOverlay.Draw(renderPass);
+        }
+
+        renderPass->end();
+    });
+
+    const uint64_t frameNumber = frameContexts.GetFrameNumber();
+    if (frameWriter && frameNumber % appOptions.captureInterval == 0)
+    {
+        frameGraph.AddPass("Readback", [&](FrameGraph::PassBuilder& builder)
+        {
+            builder.Read(target, FrameGraph::Access::Copy);
+            builder.SideEffect();
+        }, [&](const FrameGraph& graph, CommandEncoder passEncoder)
+        {
+            if (appOptions.headless)
+            {
+                frameReadback.EncodeCopy(passEncoder, graph.GetTexture(target), frameNumber);
+            }
+            else
+            {
+                GpuHandle<Texture> targetTexture{swapChain->getCurrentTexture()};
+                frameReadback.EncodeCopy(passEncoder, targetTexture, frameNumber);
+            }
+        });
+    }
+
+    if (frameGraph.Compile())
+    {
+        frameGraph.Execute(encoder);
+    }
+
+    gpuProfiler.EndFrame(encoder);
+    stagingBelt.Finish();
+    GpuHandle<CommandBuffer> command{encoder->finish(CommandBufferDescriptor{})};
+    {
+        PROFILE_ZONE("Queue::submit");
+        queue.submit(1, &command.Get());
+    }
+    stagingBelt.Recall();
+    transientPool.EndFrame();
+    frameContexts.EndFrame();
+    frameStats.RecordCpuEncode((GetTime() - encodeStart) * 1000.0);
+    if (gpuProfiler.Poll())
+    {
+        frameStats.RecordGpuTime(gpuProfiler.GetLastFrameMs());
+    }
+    if (frameWriter)
+    {
+        frameReadback.Poll(frameContexts.GetFrameNumber());
+    }
+}
+
+double GetTime()
+{
+    if (!appOptions.headless)
+    {
+        return glfwGetTime();
+    }
+    // GLFW is not initialized when running headless
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double GetAnimationTime()
+{
+    // Benchmarks advance the scene by a fixed step so every run draws the same frames
+    if (appOptions.fixedTimestep > 0.0)
+    {
+        return static_cast<double>(animationFrame) * appOptions.fixedTimestep;
+    }
+    return GetTime();
+}
+
+float GetDrawDepth(uint32_t draw)
+{
+    // Spread over (0, 1) so the depth test keeps the look of drawing them in order
+    return 1.0f - static_cast<float>(draw + 1) / static_cast<float>(drawsPerFrame + 1);
+}
+
+void CreateSwapChain()
+{
+    // Frame capture copies straight out of the swapchain texture
+    const bool capturing = !appOptions.captureDirectory.empty() || !appOptions.captureVideo.empty();
+    swapChain = GpuHandle{device.createSwapChain(windowSurface, SwapChainDescriptor
+    {{
+        .usage = capturing ? TextureUsage::RenderAttachment | TextureUsage::CopySrc : TextureUsage::RenderAttachment,
+        .format = TextureFormat::BGRA8Unorm,
+        .width = targetWidth,
+        .height = targetHeight,
+        .presentMode = presentMode,
+    }})};
+}
+
+bool ApplyPendingResize()
+{
+    if (!resizePending)
+    {
+        return targetWidth > 0 && targetHeight > 0;
+    }
+    resizePending = false;
+    if (pendingWidth == 0 || pendingHeight == 0)
+    {
+        // Keep the old swapchain while minimized, a zero-sized one is invalid
+        targetWidth = 0;
+        targetHeight = 0;
+        return false;
+    }
+    PROFILE_FUNCTION();
+    targetWidth = pendingWidth;
+    targetHeight = pendingHeight;
+    // The last frame presented from the old swapchain may still be in flight
+    frameContexts.DeferRelease(std::move(swapChain));
+    CreateSwapChain();
+    return true;
+}
+
+TextureView AcquireTargetView()
+{
+    if (appOptions.headless)
+    {
+        // Add a reference so Render() can release it like a swapchain view
+        offscreenView->reference();
+        return offscreenView;
+    }
+    return swapChain->getCurrentTextureView();
+}
+
+// Util functions
+bool LoadGeometry(const fs::path& path, std::vector<float>& pointData, std::vector<uint16_t>& indexData)
+{
+    PROFILE_FUNCTION();
+    std::ifstream file(path);
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    pointData.clear();
+    indexData.clear();
+
+    enum class Section
+    {
+        None,
+        Points,
+        Indices,
+    };
+    Section currentSection = Section::None;
+
+    float value;
+    uint16_t index;
+    std::string line;
+    while (!file.eof())
+    {
+        std::getline(file, line);
+
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        if (line == "[points]") {
+            currentSection = Section::Points;
+        }
+        else if (line == "[indices]") {
+            currentSection = Section::Indices;
+        }
+        else if (line[0] == '#' || line.empty()) {
+            // Do nothing, this is a comment
+        }
+        else if (currentSection == Section::Points) {
+            std::istringstream iss(line);
+            // Get x, y, r, g, b
+            for (int i = 0; i < 5; ++i) {
+                iss >> value;
+                pointData.push_back(value);
+            }
+        }
+        else if (currentSection == Section::Indices) {
+            std::istringstream iss(line);
+            // Get corners #0 #1 and #2
+            for (int i = 0; i < 3; ++i) {
+                iss >> index;
+                indexData.push_back(index);
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool GenerateGridGeometry(uint32_t resolution, std::vector<float>& pointData, std::vector<uint16_t>& indexData)
+{
+    PROFILE_FUNCTION();
+    // 16 bit indices address at most 256 x 256 vertices
+    if (resolution == 0 || resolution > 255)
+    {
+        return false;
+    }
+
+    pointData.clear();
+    indexData.clear();
+
+    // Same footprint as the logo so the scene stays framed the same way
+    const uint32_t side = resolution + 1;
+    for (uint32_t y = 0; y < side; ++y)
+    {
+        for (uint32_t x = 0; x < side; ++x)
+        {
+            const float u = static_cast<float>(x) / static_cast<float>(resolution);
+            const float v = static_cast<float>(y) / static_cast<float>(resolution);
+            pointData.insert(pointData.end(), { 1.375f * u, 0.866f * v, 0.0f, 0.353f + 0.25f * u, 0.612f + 0.388f * v });
+        }
+    }
+    for (uint32_t y = 0; y < resolution; ++y)
+    {
+        for (uint32_t x = 0; x < resolution; ++x)
+        {
+            const uint16_t corner = static_cast<uint16_t>(y * side + x);
+            const uint16_t above = static_cast<uint16_t>(corner + side);
+            indexData.insert(indexData.end(), { corner, static_cast<uint16_t>(corner + 1), static_cast<uint16_t>(above + 1) });
+            indexData.insert(indexData.end(), { corner, static_cast<uint16_t>(above + 1), above });
+        }
+    }
+    return true;
+}
+
+ShaderModule LoadShaderModule(const fs::path& path, Device device) 
+{
+    std::string shaderSource;
+    if (!LoadShaderSource(path, shaderSource)) {
+        return nullptr;
+    }
+    return CreateShaderModule(shaderSource, device);
+}
+
+bool LoadShaderSource(const fs::path& path, std::string& shaderSource)
+{
+    PROFILE_FUNCTION();
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    const size_t size = file.tellg();
+    shaderSource.assign(size, ' ');
+    file.seekg(0);
+    file.read(shaderSource.data(), size);
+    return true;
+}
+
+ShaderModule CreateShaderModule(const std::string& shaderSource, Device device)
+{
+    PROFILE_FUNCTION();
+    if (shaderSource.empty()) {
+        return nullptr;
+    }
+    ShaderModuleWGSLDescriptor shaderCodeDesc;
+    shaderCodeDesc.chain.next = nullptr;
+    shaderCodeDesc.chain.sType = SType::ShaderModuleWGSLDescriptor;
+    shaderCodeDesc.code = shaderSource.c_str();
+    ShaderModuleDescriptor shaderDesc{};
+    #ifdef WEBGPU_BACKEND_WGPU
+    shaderDesc.hintCount = 0;
+    shaderDesc.hints = nullptr;
+    #endif
+    shaderDesc.nextInChain = &shaderCodeDesc.chain;
+    return device.createShaderModule(shaderDesc);
+}
+
+uint32_t ceilToNextMultiple(uint32_t value, uint32_t step)
+{
+    uint32_t divide_and_ceil = value / step + (value % step == 0 ? 0 : 1);
+    return step * divide_and_ceil;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+#include "app-options.h"
+#include "frame-stats.h"
+
+// What a run measured once its frame loop ended, warmup frames excluded
+struct RunResult
+{
+    uint32_t frames{};
+    double seconds{};
+    FrameStats stats;
+    std::string adapterName;
+    double timeToFirstFrameMs{};
+    uint32_t sampleCount{1};
+    // Live color, depth and MSAA targets at the end of the run
+    uint64_t renderTargetBytes{};
+    // Attachment bytes one frame would move through memory if nothing stayed on chip: the color and
+    // depth samples and the resolve. Tile-based GPUs only write the resolve with the discarded stores.
+    uint64_t attachmentBytesPerFrame{};
+    // Share of transient texture requests the pool served from earlier frames, and what it still
+    // had to create in the last frame (0 once warmed up)
+    double transientHitRate{};
+    uint32_t transientCreatedLastFrame{};
+};
+
+// Sets up the device and the scene described by the options, renders until the window closes or
+// the headless frame count is reached and tears everything down again. Returns the exit code.
+int RunApp(const AppOptions& options, RunResult* result = nullptr);
+
+bool LoadGeometry(const std::filesystem::path& path, std::vector<float>& pointData, std::vector<uint16_t>& indexData);
+// Regular grid of resolution x resolution quads (at most 255) in the footprint of the logo
+bool GenerateGridGeometry(uint32_t resolution, std::vector<float>& pointData, std::vector<uint16_t>& indexData);
+wgpu::ShaderModule LoadShaderModule(const std::filesystem::path& path, wgpu::Device device);
+// The two halves of LoadShaderModule, the file can be read before the device exists
+bool LoadShaderSource(const std::filesystem::path& path, std::string& shaderSource);
+wgpu::ShaderModule CreateShaderModule(const std::string& shaderSource, wgpu::Device device);
+uint32_t ceilToNextMultiple(uint32_t value, uint32_t step);
@@ -0,0 +1,147 @@
+#include "asset-loader.h"
+#include "cpu-profiler.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace wgpu;
+
+AssetLoader::~AssetLoader()
+{
+    Stop();
+}
+
+void AssetLoader::Start(uint32_t threadCount)
+{
+    Stop();
+    m_Stopping = false;
+    for (uint32_t i = 0; i < std::max(threadCount, 1u); ++i)
+    {
+        m_Threads.emplace_back(&AssetLoader::WorkerLoop, this);
+    }
+}
+
+AssetLoader::Handle AssetLoader::LoadMesh(std::string name, DecodeFunction decode)
+{
+    auto asset = std::make_shared<MeshAsset>();
+    asset->m_Name = std::move(name);
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Jobs.push_back(Job{ asset, std::move(decode) });
+    }
+    m_JobCondition.notify_one();
+    return asset;
+}
+
+uint32_t AssetLoader::Pump(MeshPool& pool, StagingBelt& belt, CommandEncoder encoder, uint64_t byteBudget)
+{
+    PROFILE_FUNCTION();
+    uint32_t readyCount = 0;
+    uint64_t uploadedBytes = 0;
+    while (uploadedBytes < byteBudget)
+    {
+        std::shared_ptr<MeshAsset> asset;
+        {
+            std::lock_guard lock(m_Mutex);
+            if (m_Decoded.empty())
+            {
+                break;
+            }
+            asset = std::move(m_Decoded.front());
+            m_Decoded.pop_front();
+        }
+
+        MeshPool::Mesh mesh;
+        const MeshPool::AddResult added = pool.Add(belt, encoder, asset->m_PointData, asset->m_IndexData, mesh);
+        if (added == MeshPool::AddResult::NoStagingSpace)
+        {
+            // Only this frame is short of staging memory, the mesh goes first again next time
+            std::lock_guard lock(m_Mutex);
+            m_Decoded.push_front(std::move(asset));
+            break;
+        }
+        if (added != MeshPool::AddResult::Added)
+        {
+            std::cerr << "Mesh " << asset->m_Name << (added == MeshPool::AddResult::Empty ? " is empty!" : " does not fit into the mesh pool!") << std::endl;
+            asset->m_State = State::Failed;
+            continue;
+        }
+        uploadedBytes += asset->m_PointData.size() * sizeof(float) + asset->m_IndexData.size() * sizeof(uint16_t);
+        asset->m_Mesh = mesh;
+        asset->m_PointData = {};
+        asset->m_IndexData = {};
+        asset->m_State = State::Ready;
+        ++readyCount;
+    }
+    return readyCount;
+}
+
+void AssetLoader::WaitDecoded(const Handle& asset)
+{
+    std::unique_lock lock(m_Mutex);
+    m_DecodedCondition.wait(lock, [&] { return asset->GetState() != State::Pending || m_Threads.empty(); });
+}
+
+void AssetLoader::Stop()
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stopping = true;
+        m_Jobs.clear();
+    }
+    m_JobCondition.notify_all();
+    for (auto& thread : m_Threads)
+    {
+        thread.join();
+    }
+    std::lock_guard lock(m_Mutex);
+    m_Threads.clear();
+    m_Decoded.clear();
+    m_DecodedCondition.notify_all();
+}
+
+size_t AssetLoader::GetPendingCount() const
+{
+    std::lock_guard lock(m_Mutex);
+    return m_Jobs.size() + m_Decoding + m_Decoded.size();
+}
+
+void AssetLoader::WorkerLoop()
+{
+    CpuProfiler::SetThreadName("Asset Loader");
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock lock(m_Mutex);
+            m_JobCondition.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+            if (m_Stopping)
+            {
+                return;
+            }
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+            ++m_Decoding;
+        }
+
+        bool success;
+        {
+            PROFILE_ZONE("AssetLoader::Decode");
+            success = job.decode(job.asset->m_PointData, job.asset->m_IndexData);
+        }
+        if (!success)
+        {
+            std::cerr << "Could not load mesh " << job.asset->m_Name << "!" << std::endl;
+        }
+
+        {
+            std::lock_guard lock(m_Mutex);
+            --m_Decoding;
+            job.asset->m_State = success ? State::Decoded : State::Failed;
+            if (success)
+            {
+                m_Decoded.push_back(job.asset);
+            }
+        }
+        m_DecodedCondition.notify_all();
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+#include "mesh-pool.h"
+#include "staging-belt.h"
+
+// Loads meshes without holding up the frame loop. File I/O and decoding run on worker threads, the
+// device thread picks up the decoded meshes in Pump() and records their uploads into the frame's
+// encoder. Callers keep a handle and draw the mesh once it reports ready.
+class AssetLoader
+{
+public:
+    static constexpr uint64_t DefaultUploadBudget = 4 << 20;
+
+    enum class State
+    {
+        Pending,
+        Decoded,
+        Ready,
+        Failed,
+    };
+
+    using DecodeFunction = std::function<bool(std::vector<float>& pointData, std::vector<uint16_t>& indexData)>;
+
+    class MeshAsset
+    {
+    public:
+        State GetState() const { return m_State; }
+        bool IsReady() const { return m_State == State::Ready; }
+        bool IsFailed() const { return m_State == State::Failed; }
+        const std::string& GetName() const { return m_Name; }
+        // Valid once ready
+        const MeshPool::Mesh& GetMesh() const { return m_Mesh; }
+        // Valid from decoded until the upload, the CPU copy is dropped afterwards
+        const std::vector<float>& GetPointData() const { return m_PointData; }
+
+    private:
+        friend class AssetLoader;
+
+        std::string m_Name;
+        std::atomic<State> m_State{State::Pending};
+        std::vector<float> m_PointData;
+        std::vector<uint16_t> m_IndexData;
+        MeshPool::Mesh m_Mesh;
+    };
+
+    using Handle = std::shared_ptr<const MeshAsset>;
+
+    ~AssetLoader();
+
+    void Start(uint32_t threadCount = 2);
+    Handle LoadMesh(std::string name, DecodeFunction decode);
+    // Device thread only. Uploads decoded meshes into the pool until the byte budget is used up, a
+    // mesh larger than the budget still goes through on its own. Returns how many became ready.
+    uint32_t Pump(MeshPool& pool, StagingBelt& belt, wgpu::CommandEncoder encoder, uint64_t byteBudget = DefaultUploadBudget);
+    // Blocks until the asset is decoded or failed, for the few setups that cannot start without it
+    void WaitDecoded(const Handle& asset);
+    // Drops whatever is still queued and joins the workers
+    void Stop();
+
+    size_t GetPendingCount() const;
+
+private:
+    struct Job
+    {
+        std::shared_ptr<MeshAsset> asset;
+        DecodeFunction decode;
+    };
+
+    void WorkerLoop();
+
+    std::vector<std::thread> m_Threads;
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_JobCondition;
+    std::condition_variable m_DecodedCondition;
+    std::deque<Job> m_Jobs;
+    std::deque<std::shared_ptr<MeshAsset>> m_Decoded;
+    uint32_t m_Decoding{0};
+    bool m_Stopping{false};
+};
@@ -0,0 +1,182 @@
+#include <charconv>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "app.h"
+
+// Headless benchmark runs of fixed scenes. Every scene renders the same frames on every run: the
+// animation advances by a fixed timestep and the fallback adapter takes the display out of the loop.
+
+namespace
+{
+    struct Scene
+    {
+        const char* name;
+        const char* description;
+        std::function<void(AppOptions&)> configure;
+    };
+
+    const std::vector<Scene> scenes{
+        { "baseline", "The logo drawn twice, as the App does",
+            [](AppOptions&) {} },
+        { "many-objects", "16384 objects culled on the GPU and drawn with one indirect draw",
+            [](AppOptions& options) { options.gpuDriven = true; options.objectCount = 16384; } },
+        { "big-mesh", "One 255x255 quad grid, 130k triangles per draw",
+            [](AppOptions& options) { options.gridResolution = 255; } },
+        { "many-pipelines", "256 draws alternating between 64 pipelines",
+            [](AppOptions& options) { options.drawCount = 256; options.pipelineCount = 64; } },
+        { "uniform-churn", "1024 draws, each rewriting its own uniform slice every frame",
+            [](AppOptions& options) { options.drawCount = 1024; } },
+        // Compare against baseline and big-mesh, the same frames with one sample per pixel
+        { "msaa-4x", "baseline with 4x MSAA resolved into the target",
+            [](AppOptions& options) { options.sampleCount = 4; } },
+        { "big-mesh-msaa-4x", "big-mesh with 4x MSAA resolved into the target",
+            [](AppOptions& options) { options.gridResolution = 255; options.sampleCount = 4; } },
+    };
+
+    bool ParseUint(std::string_view text, uint32_t& value)
+    {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc{} && end == text.data() + text.size();
+    }
+
+    void PrintBenchUsage(const char* executable)
+    {
+        std::cout << "Usage: " << executable << " [options]\n"
+                  << "  --scene <name>          Run one scene instead of all of them\n"
+                  << "  --frames <n>            Measured frames per scene (default 600)\n"
+                  << "  --warmup <n>            Frames rendered before measuring (default 60)\n"
+                  << "  --output <file>         Write the results as JSON (default stdout)\n"
+                  << "  --list                  Print the scenes and exit\n";
+    }
+
+    void WriteHistogram(std::ostream& out, const char* key, const RollingHistogram& histogram)
+    {
+        out << "      \"" << key << "\": { \"mean\": " << histogram.GetMean()
+            << ", \"min\": " << histogram.GetMin()
+            << ", \"p50\": " << histogram.GetPercentile(0.5)
+            << ", \"p95\": " << histogram.GetPercentile(0.95)
+            << ", \"p99\": " << histogram.GetPercentile(0.99)
+            << ", \"max\": " << histogram.GetMax() << " }";
+    }
+
+    void WriteResult(std::ostream& out, const Scene& scene, const RunResult& result)
+    {
+        out << "    {\n"
+            << "      \"scene\": \"" << scene.name << "\",\n"
+            << "      \"adapter\": \"" << result.adapterName << "\",\n"
+            << "      \"frames\": " << result.frames << ",\n"
+            << "      \"seconds\": " << result.seconds << ",\n"
+            << "      \"time_to_first_frame_ms\": " << result.timeToFirstFrameMs << ",\n"
+            << "      \"frames_per_second\": " << (result.seconds > 0.0 ? result.frames / result.seconds : 0.0) << ",\n"
+            << "      \"sample_count\": " << result.sampleCount << ",\n"
+            << "      \"render_target_bytes\": " << result.renderTargetBytes << ",\n"
+            << "      \"attachment_bytes_per_frame\": " << result.attachmentBytesPerFrame << ",\n"
+            << "      \"transient_hit_rate\": " << result.transientHitRate << ",\n"
+            << "      \"transient_created_last_frame\": " << result.transientCreatedLastFrame << ",\n";
+        WriteHistogram(out, "frame_ms", result.stats.GetFrameTimes());
+        out << ",\n";
+        WriteHistogram(out, "cpu_encode_ms", result.stats.GetCpuEncodeTimes());
+        out << "\n    }";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string sceneName;
+    std::string outputPath;
+    uint32_t frameCount = 600;
+    uint32_t warmupFrames = 60;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--scene" && hasValue)
+        {
+            sceneName = argv[++i];
+        }
+        else if (arg == "--frames" && hasValue && ParseUint(argv[i + 1], frameCount) && frameCount > 0)
+        {
+            ++i;
+        }
+        else if (arg == "--warmup" && hasValue && ParseUint(argv[i + 1], warmupFrames))
+        {
+            ++i;
+        }
+        else if (arg == "--output" && hasValue)
+        {
+            outputPath = argv[++i];
+        }
+        else if (arg == "--list")
+        {
+            for (const Scene& scene : scenes)
+            {
+                std::cout << scene.name << ": " << scene.description << "\n";
+            }
+            return 0;
+        }
+        else
+        {
+            PrintBenchUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<const Scene*> selected;
+    for (const Scene& scene : scenes)
+    {
+        if (sceneName.empty() || sceneName == scene.name)
+        {
+            selected.push_back(&scene);
+        }
+    }
+    if (selected.empty())
+    {
+        std::cerr << "Unknown scene: " << sceneName << std::endl;
+        return 1;
+    }
+
+    std::vector<RunResult> results;
+    for (const Scene* scene : selected)
+    {
+        AppOptions options;
+        options.headless = true;
+        options.frameCount = frameCount;
+        options.warmupFrames = warmupFrames;
+        options.fixedTimestep = 1.0 / 60.0;
+        options.statsWindow = frameCount;
+        scene->configure(options);
+
+        std::cout << "Running " << scene->name << " (" << frameCount << " frames)..." << std::endl;
+        RunResult result;
+        if (RunApp(options, &result) != 0)
+        {
+            std::cerr << "Scene " << scene->name << " failed" << std::endl;
+            return 1;
+        }
+        results.push_back(std::move(result));
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty())
+    {
+        file.open(outputPath);
+        if (!file)
+        {
+            std::cerr << "Could not write " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = outputPath.empty() ? std::cout : file;
+    out << "{\n  \"frames\": " << frameCount << ",\n  \"warmup\": " << warmupFrames << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        WriteResult(out, *selected[i], results[i]);
+        out << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "cpu-profiler.h"
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace CpuProfiler
+{
+    std::atomic<bool> enabled{false};
+
+    namespace
+    {
+        struct Event
+        {
+            const char* name;
+            int64_t startNs;
+            int64_t endNs;
+        };
+
+        constexpr size_t ChunkSize = 4096;
+        constexpr size_t MaxChunks = 1024;
+
+        // Single writer (the owning thread), any number of readers. Chunks are never moved, so a
+        // reader can walk everything below the published count while the owner keeps appending.
+        struct ThreadBuffer
+        {
+            std::array<std::atomic<Event*>, MaxChunks> chunks{};
+            std::atomic<size_t> count{0};
+            std::atomic<uint64_t> dropped{0};
+            std::atomic<const char*> name{nullptr};
+            uint32_t threadId{};
+
+            ~ThreadBuffer()
+            {
+                for (auto& chunk : chunks)
+                {
+                    delete[] chunk.load();
+                }
+            }
+
+            void Push(const Event& event)
+            {
+                const size_t index = count.load(std::memory_order_relaxed);
+                const size_t chunkIndex = index / ChunkSize;
+                if (chunkIndex >= MaxChunks)
+                {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                Event* chunk = chunks[chunkIndex].load(std::memory_order_relaxed);
+                if (!chunk)
+                {
+                    chunk = new Event[ChunkSize];
+                    chunks[chunkIndex].store(chunk, std::memory_order_release);
+                }
+                chunk[index % ChunkSize] = event;
+                count.store(index + 1, std::memory_order_release);
+            }
+        };
+
+        // The registry keeps the buffers alive after their threads exit so they can still be exported
+        std::mutex registryMutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> registry;
+
+        ThreadBuffer& GetThreadBuffer()
+        {
+            thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+                auto newBuffer = std::make_shared<ThreadBuffer>();
+                std::lock_guard lock(registryMutex);
+                newBuffer->threadId = static_cast<uint32_t>(registry.size() + 1);
+                registry.push_back(newBuffer);
+                return newBuffer;
+            }();
+            return *buffer;
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+
+        void WriteEscaped(std::ostream& out, const char* text)
+        {
+            for (const char* c = text; *c; ++c)
+            {
+                if (*c == '"' || *c == '\\') out << '\\';
+                out << *c;
+            }
+        }
+    }
+
+    void SetEnabled(bool value)
+    {
+        enabled.store(value, std::memory_order_relaxed);
+    }
+
+    void SetThreadName(const char* name)
+    {
+        GetThreadBuffer().name.store(name, std::memory_order_relaxed);
+    }
+
+    int64_t NowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    void Record(const char* name, int64_t startNs, int64_t endNs)
+    {
+        GetThreadBuffer().Push({ name, startNs, endNs });
+    }
+
+    bool ExportChromeTrace(const std::filesystem::path& path)
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            std::lock_guard lock(registryMutex);
+            buffers = registry;
+        }
+
+        // Chrome wants microseconds
+        file << std::fixed << std::setprecision(3);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        for (const auto& buffer : buffers)
+        {
+            if (const char* name = buffer->name.load(std::memory_order_relaxed))
+            {
+                file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                     << ",\"args\":{\"name\":\"";
+                WriteEscaped(file, name);
+                file << "\"}}";
+                first = false;
+            }
+
+            const size_t count = buffer->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Event& event = buffer->chunks[i / ChunkSize].load(std::memory_order_acquire)[i % ChunkSize];
+                file << (first ? "" : ",\n") << "{\"name\":\"";
+                WriteEscaped(file, event.name);
+                file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                     << ",\"ts\":" << static_cast<double>(event.startNs) / 1000.0
+                     << ",\"dur\":" << static_cast<double>(event.endNs - event.startNs) / 1000.0 << '}';
+                first = false;
+            }
+        }
+        file << "\n]}\n";
+        return file.good();
+    }
+
+    uint64_t GetDroppedCount()
+    {
+        std::lock_guard lock(registryMutex);
+        uint64_t dropped = 0;
+        for (const auto& buffer : registry)
+        {
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+
+// Scoped CPU zones, exported as Chrome trace_event JSON (open in Perfetto or chrome://tracing).
+// Every thread appends to its own buffer without locking. While the profiler is disabled a zone
+// costs one relaxed atomic load. Zone names must outlive the profiler, use string literals.
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) CpuProfiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+
+namespace CpuProfiler
+{
+    extern std::atomic<bool> enabled;
+
+    inline bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+    void SetEnabled(bool value);
+    // Names the calling thread in the exported trace
+    void SetThreadName(const char* name);
+
+    int64_t NowNs();
+    void Record(const char* name, int64_t startNs, int64_t endNs);
+
+    // Only reads what every thread has published so far, the threads can keep recording meanwhile
+    bool ExportChromeTrace(const std::filesystem::path& path);
+    uint64_t GetDroppedCount();
+
+    class Zone
+    {
+    public:
+        explicit Zone(const char* name)
+            : m_Name(IsEnabled() ? name : nullptr)
+            , m_Start(m_Name ? NowNs() : 0)
+        {
+        }
+
+        ~Zone()
+        {
+            if (m_Name)
+            {
+                Record(m_Name, m_Start, NowNs());
+            }
+        }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* m_Name;
+        int64_t m_Start;
+    };
+}
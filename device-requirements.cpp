@@ -0,0 +1,131 @@
+#include "device-requirements.h"
+#include <algorithm>
+#include <ostream>
+
+using namespace wgpu;
+
+namespace
+{
+    const char* GetFeatureName(FeatureName feature)
+    {
+        switch (feature)
+        {
+        case FeatureName::TimestampQuery: return "timestamp-query";
+        case FeatureName::ShaderF16: return "shader-f16";
+        case FeatureName::IndirectFirstInstance: return "indirect-first-instance";
+        case FeatureName::DepthClipControl: return "depth-clip-control";
+        case FeatureName::Depth32FloatStencil8: return "depth32float-stencil8";
+#ifdef WEBGPU_BACKEND_DAWN
+        case FeatureName::TransientAttachments: return "transient-attachments";
+#endif
+        default: return "other";
+        }
+    }
+}
+
+DeviceRequirements::DeviceRequirements(Adapter adapter)
+    : m_Adapter(adapter)
+    , m_Supported(Default)
+    , m_Required(Default)
+{
+#ifdef __EMSCRIPTEN__
+    // The browser adapter does not report its limits here, assume the spec minimums for the alignments
+    m_Supported.limits.minStorageBufferOffsetAlignment = 256;
+    m_Supported.limits.minUniformBufferOffsetAlignment = 256;
+    m_KnowsSupported = false;
+#else
+    adapter.getLimits(&m_Supported);
+#endif
+    // Lower is better for the alignments, the adapter's own value is the best there is
+    m_Required.limits.minStorageBufferOffsetAlignment = m_Supported.limits.minStorageBufferOffsetAlignment;
+    m_Required.limits.minUniformBufferOffsetAlignment = m_Supported.limits.minUniformBufferOffsetAlignment;
+}
+
+void DeviceRequirements::Require(uint32_t WGPULimits::* limit, uint32_t value, const char* name)
+{
+    uint32_t& required = m_Required.limits.*limit;
+    if (required == WGPU_LIMIT_U32_UNDEFINED || required < value)
+    {
+        required = value;
+    }
+    Remember({ name, limit, nullptr });
+}
+
+void DeviceRequirements::Require(uint64_t WGPULimits::* limit, uint64_t value, const char* name)
+{
+    uint64_t& required = m_Required.limits.*limit;
+    if (required == WGPU_LIMIT_U64_UNDEFINED || required < value)
+    {
+        required = value;
+    }
+    Remember({ name, nullptr, limit });
+}
+
+void DeviceRequirements::RequireSupported(uint32_t WGPULimits::* limit, const char* name)
+{
+    if (m_KnowsSupported)
+    {
+        Require(limit, m_Supported.limits.*limit, name);
+    }
+}
+
+bool DeviceRequirements::RequestFeature(FeatureName feature)
+{
+    if (!m_Adapter.hasFeature(feature))
+    {
+        return false;
+    }
+    if (std::find(m_Features.begin(), m_Features.end(), feature) == m_Features.end())
+    {
+        m_Features.push_back(feature);
+    }
+    return true;
+}
+
+bool DeviceRequirements::Validate(std::ostream& out) const
+{
+    if (!m_KnowsSupported)
+    {
+        return true;
+    }
+    bool valid = true;
+    for (const Requirement& requirement : m_Requirements)
+    {
+        const uint64_t required = requirement.limit32 ? m_Required.limits.*requirement.limit32 : m_Required.limits.*requirement.limit64;
+        const uint64_t supported = requirement.limit32 ? m_Supported.limits.*requirement.limit32 : m_Supported.limits.*requirement.limit64;
+        if (required > supported)
+        {
+            out << "The adapter does not support " << requirement.name << " = " << required << ", its maximum is " << supported << '\n';
+            valid = false;
+        }
+    }
+    return valid;
+}
+
+void DeviceRequirements::PrintSummary(std::ostream& out) const
+{
+    out << "Device limits:";
+    for (const Requirement& requirement : m_Requirements)
+    {
+        out << ' ' << requirement.name << '=' << (requirement.limit32 ? m_Required.limits.*requirement.limit32 : m_Required.limits.*requirement.limit64);
+    }
+    out << "\nDevice features:";
+    if (m_Features.empty())
+    {
+        out << " none";
+    }
+    for (FeatureName feature : m_Features)
+    {
+        out << ' ' << GetFeatureName(feature);
+    }
+    out << '\n';
+}
+
+void DeviceRequirements::Remember(const Requirement& requirement)
+{
+    auto sameLimit = [&](const Requirement& other) { return other.limit32 == requirement.limit32 && other.limit64 == requirement.limit64; };
+    if (std::none_of(m_Requirements.begin(), m_Requirements.end(), sameLimit))
+    {
+        m_Requirements.push_back(requirement);
+    }
+}
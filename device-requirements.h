@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+
+// Builds the limits and features of the device request from what the scene actually needs. Every
+// Require() only raises a limit, Validate() then checks the result against the adapter and names each
+// limit it falls short on. Optional features are enabled when the adapter has them and the caller
+// keeps a fallback for the others.
+class DeviceRequirements
+{
+public:
+    explicit DeviceRequirements(wgpu::Adapter adapter);
+
+    void Require(uint32_t WGPULimits::* limit, uint32_t value, const char* name);
+    void Require(uint64_t WGPULimits::* limit, uint64_t value, const char* name);
+    // All the adapter offers, for limits that grow at runtime such as the window size
+    void RequireSupported(uint32_t WGPULimits::* limit, const char* name);
+    // True when the adapter has the feature and it was added to the request
+    bool RequestFeature(wgpu::FeatureName feature);
+
+    // Prints every required limit the adapter cannot meet
+    bool Validate(std::ostream& out) const;
+    void PrintSummary(std::ostream& out) const;
+
+    const wgpu::SupportedLimits& GetSupportedLimits() const { return m_Supported; }
+    const wgpu::RequiredLimits& GetRequiredLimits() const { return m_Required; }
+    const std::vector<wgpu::FeatureName>& GetFeatures() const { return m_Features; }
+
+private:
+    struct Requirement
+    {
+        const char* name;
+        uint32_t WGPULimits::* limit32;
+        uint64_t WGPULimits::* limit64;
+    };
+
+    void Remember(const Requirement& requirement);
+
+    wgpu::Adapter m_Adapter;
+    wgpu::SupportedLimits m_Supported;
+    wgpu::RequiredLimits m_Required;
+    std::vector<Requirement> m_Requirements;
+    std::vector<wgpu::FeatureName> m_Features;
+    bool m_KnowsSupported{true};
+};
@@ -0,0 +1,33 @@
+#include "draw-sorter.h"
+#include <algorithm>
+
+namespace
+{
+    constexpr uint64_t TranslucentBit = 1ull << 63;
+    constexpr uint32_t DepthMax = 0x7fffffff;
+}
+
+void DrawSorter::Clear()
+{
+    m_Keys.clear();
+    m_Order.clear();
+    m_OpaqueCount = 0;
+}
+
+void DrawSorter::Add(uint32_t index, float depth, bool translucent)
+{
+    const uint32_t quantized = static_cast<uint32_t>(std::clamp(depth, 0.0f, 1.0f) * static_cast<float>(DepthMax));
+    const uint64_t depthBits = translucent ? DepthMax - std::min(quantized, DepthMax) : std::min(quantized, DepthMax);
+    m_Keys.push_back((translucent ? TranslucentBit : 0) | depthBits << 32 | index);
+    if (!translucent)
+    {
+        ++m_OpaqueCount;
+    }
+}
+
+void DrawSorter::Sort()
+{
+    std::sort(m_Keys.begin(), m_Keys.end());
+    m_Order.resize(m_Keys.size());
+    std::transform(m_Keys.begin(), m_Keys.end(), m_Order.begin(), [](uint64_t key) { return static_cast<uint32_t>(key); });
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Orders the draws of a pass for the depth test. Opaque draws come first, front to back, so early-Z
+// rejects the fragments of everything they cover. Translucent draws follow back to front, they test
+// against the opaque depth without writing it. Each draw is packed into one 64 bit key: the
+// translucent bit, the quantized depth (inverted for translucent draws) and the draw index, which
+// also keeps the order of draws at the same depth stable.
+class DrawSorter
+{
+public:
+    void Clear();
+    // depth in [0, 1], smaller is nearer
+    void Add(uint32_t index, float depth, bool translucent);
+    void Sort();
+
+    // The indices passed to Add() in draw order, valid after Sort()
+    const std::vector<uint32_t>& GetOrder() const { return m_Order; }
+    uint32_t GetOpaqueCount() const { return m_OpaqueCount; }
+
+private:
+    std::vector<uint64_t> m_Keys;
+    std::vector<uint32_t> m_Order;
+    uint32_t m_OpaqueCount{};
+};
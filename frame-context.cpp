@@ -0,0 +1,89 @@
+#include "frame-context.h"
+#include "cpu-profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace wgpu;
+
+void FrameContextManager::Init(Device device, Queue queue, uint32_t framesInFlight)
+{
+    m_Device = device;
+    m_Queue = queue;
+    m_Slots = std::vector<Slot>(std::clamp(framesInFlight, 1u, MaxFramesInFlight));
+    m_FrameIndex = 0;
+    m_FrameNumber = 0;
+}
+
+uint32_t FrameContextManager::BeginFrame()
+{
+    m_FrameIndex = static_cast<uint32_t>(m_FrameNumber % m_Slots.size());
+    Slot& slot = m_Slots[m_FrameIndex];
+
+    const auto start = std::chrono::steady_clock::now();
+    WaitForSlot(slot);
+    m_LastWaitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_MaxWaitMs = std::max(m_MaxWaitMs, m_LastWaitMs);
+    m_TotalWaitMs += m_LastWaitMs;
+
+    Retire(slot);
+    return m_FrameIndex;
+}
+
+void FrameContextManager::EndFrame()
+{
+    Slot& slot = m_Slots[m_FrameIndex];
+    slot.inFlight = true;
+
+    auto onWorkDone = [](WGPUQueueWorkDoneStatus, void* pUserData) {
+        // Even when the device is lost the slot must not stay busy forever
+        reinterpret_cast<Slot*>(pUserData)->inFlight = false;
+    };
+    wgpuQueueOnSubmittedWorkDone(m_Queue, onWorkDone, &slot);
+
+    ++m_FrameNumber;
+}
+
+void FrameContextManager::OnRetire(std::function<void()> callback)
+{
+    if (m_Slots.empty())
+    {
+        callback();
+        return;
+    }
+    m_Slots[m_FrameIndex].retireCallbacks.push_back(std::move(callback));
+}
+
+void FrameContextManager::WaitIdle()
+{
+    for (Slot& slot : m_Slots)
+    {
+        WaitForSlot(slot);
+        Retire(slot);
+    }
+}
+
+void FrameContextManager::WaitForSlot(Slot& slot)
+{
+    PROFILE_ZONE("WaitForFrameSlot");
+    while (slot.inFlight)
+    {
+#ifdef WEBGPU_BACKEND_DAWN
+        m_Device.tick();
+        std::this_thread::yield();
+#else
+        // The browser resolves the callback from its own event loop, we cannot block on it here
+        slot.inFlight = false;
+#endif
+    }
+}
+
+void FrameContextManager::Retire(Slot& slot)
+{
+    std::vector<std::function<void()>> callbacks;
+    callbacks.swap(slot.retireCallbacks);
+    for (auto& callback : callbacks)
+    {
+        callback();
+    }
+}
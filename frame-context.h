@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+#include "gpu-handle.h"
+
+// Keeps the CPU at most N frames ahead of the GPU. Every frame owns a slot (a slice of the
+// per-frame uniforms, and whatever was released while the frame was recorded) that is only handed
+// out again once queue.onSubmittedWorkDone reported the GPU finished the frame that last used it.
+// Staging chunks do not need it, they are only reused once their own mapAsync completed.
+class FrameContextManager
+{
+public:
+    static constexpr uint32_t MaxFramesInFlight = 8;
+
+    void Init(wgpu::Device device, wgpu::Queue queue, uint32_t framesInFlight);
+    // Waits until the slot of the next frame is retired and runs its retire callbacks.
+    uint32_t BeginFrame();
+    // Call right after the frame was submitted, the slot stays busy until the GPU is done with it.
+    void EndFrame();
+    // Runs once the GPU finished the current frame, to recycle what the frame used. Before Init there
+    // is no frame to wait for and the callback runs right away.
+    void OnRetire(std::function<void()> callback);
+    // Releases the object once the GPU finished the current frame instead of right away, so
+    // resources can be dropped while commands recorded this frame still use them.
+    template<typename T>
+    void DeferRelease(GpuHandle<T> handle)
+    {
+        if (T object = handle.Detach())
+        {
+            OnRetire([object]() mutable { ReleaseGpuObject(object); });
+        }
+    }
+    void WaitIdle();
+
+    uint32_t GetFrameIndex() const { return m_FrameIndex; }
+    uint32_t GetFramesInFlight() const { return static_cast<uint32_t>(m_Slots.size()); }
+    uint64_t GetFrameNumber() const { return m_FrameNumber; }
+
+    // Time the CPU spent blocked on the GPU in BeginFrame
+    double GetLastWaitMs() const { return m_LastWaitMs; }
+    double GetMaxWaitMs() const { return m_MaxWaitMs; }
+    double GetAverageWaitMs() const { return m_FrameNumber > 0 ? m_TotalWaitMs / static_cast<double>(m_FrameNumber) : 0.0; }
+
+private:
+    struct Slot
+    {
+        bool inFlight{false};
+        std::vector<std::function<void()>> retireCallbacks;
+    };
+
+    void WaitForSlot(Slot& slot);
+    static void Retire(Slot& slot);
+
+    wgpu::Device m_Device{nullptr};
+    wgpu::Queue m_Queue{nullptr};
+    std::vector<Slot> m_Slots;
+    uint32_t m_FrameIndex{};
+    uint64_t m_FrameNumber{};
+
+    double m_LastWaitMs{};
+    double m_MaxWaitMs{};
+    double m_TotalWaitMs{};
+};
@@ -0,0 +1,288 @@
+#include "frame-graph.h"
+#include "cpu-profiler.h"
+#include "gpu-tracker.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace wgpu;
+
+namespace
+{
+    WGPUTextureUsageFlags GetUsage(FrameGraph::Access access, bool write)
+    {
+        switch (access)
+        {
+        case FrameGraph::Access::Attachment: return TextureUsage::RenderAttachment;
+        case FrameGraph::Access::Sampled: return TextureUsage::TextureBinding;
+        case FrameGraph::Access::Copy: return write ? TextureUsage::CopyDst : TextureUsage::CopySrc;
+        default: return TextureUsage::None;
+        }
+    }
+
+    TextureDescriptor MakeDescriptor(const FrameGraph::TextureDesc& desc, WGPUTextureUsageFlags usage)
+    {
+        return TextureDescriptor
+        {{
+            .label = desc.label,
+            .usage = usage,
+            .dimension = TextureDimension::_2D,
+            .size = {desc.width, desc.height, 1},
+            .format = desc.format,
+            .mipLevelCount = 1,
+            .sampleCount = desc.sampleCount,
+            .viewFormatCount = 0,
+            .viewFormats = nullptr,
+        }};
+    }
+}
+
+FrameGraph::ResourceId FrameGraph::PassBuilder::Create(const TextureDesc& desc)
+{
+    m_Graph.m_Resources.push_back(Resource{ desc.label, false, false, desc });
+    const ResourceId resource = static_cast<ResourceId>(m_Graph.m_Resources.size() - 1);
+    return Write(resource, Access::Attachment);
+}
+
+FrameGraph::ResourceId FrameGraph::PassBuilder::Read(ResourceId resource, Access access)
+{
+    m_Graph.m_Resources[resource].usage |= GetUsage(access, false);
+    m_Graph.m_Passes[m_Pass].reads.push_back(resource);
+    return resource;
+}
+
+FrameGraph::ResourceId FrameGraph::PassBuilder::Write(ResourceId resource, Access access)
+{
+    m_Graph.m_Resources[resource].usage |= GetUsage(access, true);
+    m_Graph.m_Passes[m_Pass].writes.push_back(resource);
+    return resource;
+}
+
+void FrameGraph::PassBuilder::SideEffect()
+{
+    m_Graph.m_Passes[m_Pass].sideEffect = true;
+}
+
+void FrameGraph::Init(TransientPool& pool)
+{
+    m_Pool = &pool;
+}
+
+void FrameGraph::Reset()
+{
+    // The work that used them was submitted already, the pool can hand them out again right away
+    for (const Physical& entry : m_Physical)
+    {
+        if (m_Pool)
+        {
+            m_Pool->ReleaseTexture(entry.pooled.texture);
+        }
+    }
+    m_Physical.clear();
+    m_Resources.clear();
+    m_Passes.clear();
+    m_Order.clear();
+    m_Stats = Stats{};
+}
+
+void FrameGraph::Release()
+{
+    Reset();
+    m_Pool = nullptr;
+}
+
+FrameGraph::ResourceId FrameGraph::ImportTexture(const char* name, Texture texture, TextureView view)
+{
+    Resource resource{ name, true, false };
+    resource.texture = texture;
+    resource.view = view;
+    m_Resources.push_back(resource);
+    return static_cast<ResourceId>(m_Resources.size() - 1);
+}
+
+FrameGraph::ResourceId FrameGraph::ImportBuffer(const char* name, Buffer buffer)
+{
+    Resource resource{ name, true, true };
+    resource.buffer = buffer;
+    m_Resources.push_back(resource);
+    return static_cast<ResourceId>(m_Resources.size() - 1);
+}
+
+void FrameGraph::AddPass(const char* name, const SetupFunction& setup, ExecuteFunction execute)
+{
+    m_Passes.push_back(Pass{ name, std::move(execute) });
+    PassBuilder builder(*this, static_cast<uint32_t>(m_Passes.size() - 1));
+    setup(builder);
+}
+
+bool FrameGraph::Compile()
+{
+    PROFILE_FUNCTION();
+    CullPasses();
+
+    for (uint32_t pass = 0; pass < m_Passes.size(); ++pass)
+    {
+        if (!m_Passes[pass].culled)
+        {
+            m_Order.push_back(pass);
+        }
+    }
+    std::vector<bool> written(m_Resources.size(), false);
+    for (uint32_t position = 0; position < m_Order.size(); ++position)
+    {
+        const Pass& pass = m_Passes[m_Order[position]];
+        for (ResourceId id : pass.reads)
+        {
+            // A transient read before any pass wrote it would only hold garbage
+            if (!m_Resources[id].imported && !written[id])
+            {
+                std::cerr << "Frame graph pass " << pass.name << " reads " << m_Resources[id].name << " before it is written" << std::endl;
+                return false;
+            }
+        }
+        for (const auto* accesses : { &pass.reads, &pass.writes })
+        {
+            for (ResourceId id : *accesses)
+            {
+                Resource& resource = m_Resources[id];
+                resource.firstUse = std::min(resource.firstUse, position);
+                resource.lastUse = std::max(resource.lastUse, position);
+            }
+        }
+        for (ResourceId id : pass.writes)
+        {
+            written[id] = true;
+        }
+    }
+
+    AssignPhysicalTextures();
+    m_Stats.passCount = static_cast<uint32_t>(m_Passes.size());
+    m_Stats.culledPassCount = static_cast<uint32_t>(m_Passes.size() - m_Order.size());
+    return true;
+}
+
+void FrameGraph::Execute(CommandEncoder encoder) const
+{
+    for (uint32_t pass : m_Order)
+    {
+        PROFILE_ZONE(m_Passes[pass].name);
+        m_Passes[pass].execute(*this, encoder);
+    }
+}
+
+Texture FrameGraph::GetTexture(ResourceId resource) const
+{
+    return m_Resources[resource].texture;
+}
+
+TextureView FrameGraph::GetView(ResourceId resource) const
+{
+    return m_Resources[resource].view;
+}
+
+Buffer FrameGraph::GetBuffer(ResourceId resource) const
+{
+    return m_Resources[resource].buffer;
+}
+
+void FrameGraph::PrintReport(std::ostream& out) const
+{
+    out << "Frame graph: " << m_Stats.passCount << " passes (" << m_Stats.culledPassCount << " culled), "
+        << m_Stats.transientTextureCount << " transient textures in " << m_Stats.physicalTextureCount << " physical ones, "
+        << m_Stats.physicalBytes / 1024 << " KB instead of " << m_Stats.transientBytes / 1024 << " KB\n";
+    for (uint32_t pass : m_Order)
+    {
+        out << "  " << m_Passes[pass].name << '\n';
+    }
+}
+
+bool FrameGraph::IsCompatible(const TextureDesc& a, const TextureDesc& b)
+{
+    return a.width == b.width && a.height == b.height && a.format == b.format && a.sampleCount == b.sampleCount && a.extraUsage == b.extraUsage;
+}
+
+void FrameGraph::CullPasses()
+{
+    // Walk back from the outputs: a pass survives when it has side effects, writes an imported
+    // resource or writes something a surviving pass after it reads
+    std::vector<bool> needed(m_Resources.size(), false);
+    for (size_t index = m_Passes.size(); index-- > 0;)
+    {
+        Pass& pass = m_Passes[index];
+        const bool output = pass.sideEffect || std::any_of(pass.writes.begin(), pass.writes.end(), [&](ResourceId id) {
+            return m_Resources[id].imported || needed[id];
+        });
+        pass.culled = !output;
+        if (output)
+        {
+            for (ResourceId id : pass.reads)
+            {
+                needed[id] = true;
+            }
+        }
+    }
+}
+
+void FrameGraph::AssignPhysicalTextures()
+{
+    // Greedy interval assignment in order of first use: a transient takes the first compatible slot
+    // whose last user ran before its first one
+    struct Slot
+    {
+        TextureDesc desc;
+        WGPUTextureUsageFlags usage;
+        uint32_t lastUse;
+    };
+    std::vector<ResourceId> transients;
+    for (ResourceId id = 0; id < m_Resources.size(); ++id)
+    {
+        const Resource& resource = m_Resources[id];
+        if (!resource.imported && resource.firstUse != ~0u)
+        {
+            transients.push_back(id);
+        }
+    }
+    std::stable_sort(transients.begin(), transients.end(), [this](ResourceId a, ResourceId b) {
+        return m_Resources[a].firstUse < m_Resources[b].firstUse;
+    });
+
+    std::vector<Slot> slots;
+    for (ResourceId id : transients)
+    {
+        Resource& resource = m_Resources[id];
+        auto slot = std::find_if(slots.begin(), slots.end(), [&](const Slot& candidate) {
+            return IsCompatible(candidate.desc, resource.desc) && candidate.lastUse < resource.firstUse;
+        });
+        if (slot == slots.end())
+        {
+            slots.push_back(Slot{ resource.desc, 0, 0 });
+            slot = slots.end() - 1;
+        }
+        slot->usage |= resource.usage | resource.desc.extraUsage;
+        slot->lastUse = resource.lastUse;
+        resource.physical = static_cast<uint32_t>(slot - slots.begin());
+        m_Stats.transientBytes += GpuTracker::EstimateTextureBytes(MakeDescriptor(resource.desc, 0));
+    }
+
+    // Without a pool the graph only plans, the resources keep null textures
+    const uint32_t createdBefore = m_Pool ? m_Pool->GetStats().createdThisFrame : 0;
+    m_Physical.reserve(slots.size());
+    for (const Slot& slot : slots)
+    {
+        const TransientPool::PooledTexture pooled = m_Pool ? m_Pool->AcquireTexture(MakeDescriptor(slot.desc, slot.usage)) : TransientPool::PooledTexture{};
+        m_Physical.push_back(Physical{ slot.desc, slot.usage, pooled });
+    }
+    m_Stats.createdTextureCount = m_Pool ? m_Pool->GetStats().createdThisFrame - createdBefore : 0;
+
+    for (ResourceId id : transients)
+    {
+        Resource& resource = m_Resources[id];
+        resource.texture = m_Physical[resource.physical].pooled.texture;
+        resource.view = m_Physical[resource.physical].pooled.view;
+    }
+    m_Stats.transientTextureCount = static_cast<uint32_t>(transients.size());
+    m_Stats.physicalTextureCount = static_cast<uint32_t>(m_Physical.size());
+    for (const Physical& entry : m_Physical)
+    {
+        m_Stats.physicalBytes += GpuTracker::EstimateTextureBytes(MakeDescriptor(entry.desc, entry.usage));
+    }
+}
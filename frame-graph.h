@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+#include "transient-pool.h"
+
+// The passes of one frame, declared with the resources they create, read and write. Compile() culls
+// the passes nothing downstream depends on, derives the lifetime of every transient texture from the
+// first and last surviving pass that touches it, and lets transient textures with the same descriptor
+// and disjoint lifetimes share one physical texture. Execute() runs the surviving passes in the order
+// they were added: a pass can only depend on earlier ones, so that order is already a topological one.
+// WebGPU places the barriers itself, the graph decides which textures exist and which passes run.
+// Imported resources (the swapchain view, buffers owned elsewhere) outlive the frame, writing one
+// makes a pass an output of the frame. Physical textures come from a TransientPool and go back to
+// it on the next Reset(), so they carry over to later frames and to other users of the pool.
+class FrameGraph
+{
+public:
+    using ResourceId = uint32_t;
+    static constexpr ResourceId InvalidResource = ~0u;
+
+    struct TextureDesc
+    {
+        const char* label{nullptr};
+        uint32_t width{};
+        uint32_t height{};
+        wgpu::TextureFormat format{wgpu::TextureFormat::Undefined};
+        uint32_t sampleCount{1};
+        // On top of the usages the accesses imply, transient attachments for instance
+        WGPUTextureUsageFlags extraUsage{};
+    };
+
+    enum class Access
+    {
+        Attachment,
+        Sampled,
+        Copy,
+    };
+
+    class PassBuilder
+    {
+    public:
+        // A transient texture, written by this pass first
+        ResourceId Create(const TextureDesc& desc);
+        ResourceId Read(ResourceId resource, Access access = Access::Sampled);
+        ResourceId Write(ResourceId resource, Access access = Access::Attachment);
+        // Keep the pass even though nothing reads what it writes (readbacks, queries)
+        void SideEffect();
+
+    private:
+        friend class FrameGraph;
+        PassBuilder(FrameGraph& graph, uint32_t pass) : m_Graph(graph), m_Pass(pass) {}
+
+        FrameGraph& m_Graph;
+        uint32_t m_Pass;
+    };
+
+    using SetupFunction = std::function<void(PassBuilder&)>;
+    using ExecuteFunction = std::function<void(const FrameGraph&, wgpu::CommandEncoder)>;
+
+    struct Stats
+    {
+        uint32_t passCount{};
+        uint32_t culledPassCount{};
+        uint32_t transientTextureCount{};
+        uint32_t physicalTextureCount{};
+        // What the transient textures would take each on their own, and what the shared ones take
+        uint64_t transientBytes{};
+        uint64_t physicalBytes{};
+        // Physical textures the pool had to create this frame, 0 while the frame looks like the previous one
+        uint32_t createdTextureCount{};
+    };
+
+    // A graph that was never initialized still compiles: it culls and aliases, but creates no textures
+    void Init(TransientPool& pool);
+    // Drops the passes and resources of the last frame and hands its physical textures back to the pool
+    void Reset();
+    void Release();
+
+    ResourceId ImportTexture(const char* name, wgpu::Texture texture, wgpu::TextureView view);
+    ResourceId ImportBuffer(const char* name, wgpu::Buffer buffer);
+    void AddPass(const char* name, const SetupFunction& setup, ExecuteFunction execute);
+
+    bool Compile();
+    void Execute(wgpu::CommandEncoder encoder) const;
+
+    // For the execute callbacks
+    wgpu::Texture GetTexture(ResourceId resource) const;
+    wgpu::TextureView GetView(ResourceId resource) const;
+    wgpu::Buffer GetBuffer(ResourceId resource) const;
+
+    const Stats& GetStats() const { return m_Stats; }
+    void PrintReport(std::ostream& out) const;
+
+private:
+    struct Resource
+    {
+        const char* name;
+        bool imported;
+        bool isBuffer;
+        TextureDesc desc;
+        WGPUTextureUsageFlags usage{};
+        wgpu::Texture texture{nullptr};
+        wgpu::TextureView view{nullptr};
+        wgpu::Buffer buffer{nullptr};
+        // Execution order range of the surviving passes that touch it
+        uint32_t firstUse{~0u};
+        uint32_t lastUse{};
+        uint32_t physical{~0u};
+    };
+
+    struct Pass
+    {
+        const char* name;
+        ExecuteFunction execute;
+        std::vector<ResourceId> reads;
+        std::vector<ResourceId> writes;
+        bool sideEffect{false};
+        bool culled{false};
+    };
+
+    struct Physical
+    {
+        TextureDesc desc;
+        WGPUTextureUsageFlags usage{};
+        TransientPool::PooledTexture pooled;
+    };
+
+    static bool IsCompatible(const TextureDesc& a, const TextureDesc& b);
+    void CullPasses();
+    void AssignPhysicalTextures();
+
+    TransientPool* m_Pool{nullptr};
+    std::vector<Resource> m_Resources;
+    std::vector<Pass> m_Passes;
+    std::vector<uint32_t> m_Order;
+    std::vector<Physical> m_Physical;
+    Stats m_Stats;
+};
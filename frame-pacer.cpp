@@ -0,0 +1,148 @@
+#include "frame-pacer.h"
+#include "cpu-profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <thread>
+
+using namespace wgpu;
+
+std::vector<PresentMode> GetSupportedPresentModes(BackendType backendType)
+{
+#ifdef __EMSCRIPTEN__
+    // The browser presents with requestAnimationFrame
+    (void)backendType;
+    return { PresentMode::Fifo };
+#else
+    switch (backendType)
+    {
+    case BackendType::Vulkan:
+    case BackendType::D3D12:
+    case BackendType::D3D11:
+        return { PresentMode::Fifo, PresentMode::Mailbox, PresentMode::Immediate };
+    case BackendType::Metal:
+        return { PresentMode::Fifo, PresentMode::Immediate };
+    default:
+        return { PresentMode::Fifo };
+    }
+#endif
+}
+
+bool ParsePresentMode(std::string_view name, PresentMode& mode)
+{
+    if (name == "fifo") mode = PresentMode::Fifo;
+    else if (name == "mailbox") mode = PresentMode::Mailbox;
+    else if (name == "immediate") mode = PresentMode::Immediate;
+    else return false;
+    return true;
+}
+
+const char* GetPresentModeName(PresentMode mode)
+{
+    switch (mode)
+    {
+    case PresentMode::Fifo: return "fifo";
+    case PresentMode::Mailbox: return "mailbox";
+    case PresentMode::Immediate: return "immediate";
+    default: return "unknown";
+    }
+}
+
+FramePacer::FramePacer(Clock clock, double fpsCap)
+    : m_Clock(clock)
+    , m_Period(fpsCap > 0.0 ? 1.0 / fpsCap : 0.0)
+{
+}
+
+double FramePacer::WaitForNextFrame()
+{
+    double now = m_Clock();
+    if (m_Period <= 0.0)
+    {
+        return now;
+    }
+    if (m_NextDeadline < 0.0 || now - m_NextDeadline > m_Period)
+    {
+        // First frame, or more than a frame behind. Catching up would only render a burst of frames.
+        m_NextDeadline = now;
+    }
+
+    const double sleepUntil = m_NextDeadline - GetSpinSeconds();
+    if (now < sleepUntil)
+    {
+        PROFILE_ZONE("FramePacer::Sleep");
+        std::this_thread::sleep_for(std::chrono::duration<double>(sleepUntil - now));
+        now = m_Clock();
+        m_SleepOvershoot.Add(std::max(now - sleepUntil, 0.0) * 1000.0);
+    }
+    if (now < m_NextDeadline)
+    {
+        PROFILE_ZONE("FramePacer::Spin");
+        while (now < m_NextDeadline)
+        {
+            std::this_thread::yield();
+            now = m_Clock();
+        }
+    }
+
+    m_WakeError.Add((now - m_NextDeadline) * 1000.0);
+    m_NextDeadline += m_Period;
+    return now;
+}
+
+void FramePacer::MarkInputSampled()
+{
+    m_InputTime = m_Clock();
+}
+
+void FramePacer::MarkPresented(PresentMode mode)
+{
+    if (m_InputTime < 0.0)
+    {
+        return;
+    }
+    auto entry = std::find_if(m_Latency.begin(), m_Latency.end(), [mode](const ModeLatency& latency) { return latency.mode == mode; });
+    if (entry == m_Latency.end())
+    {
+        m_Latency.push_back(ModeLatency{ mode, RollingHistogram{1024} });
+        entry = m_Latency.end() - 1;
+    }
+    entry->latency.Add((m_Clock() - m_InputTime) * 1000.0);
+    m_InputTime = -1.0;
+}
+
+double FramePacer::GetSpinSeconds() const
+{
+    if (m_SleepOvershoot.GetCount() == 0)
+    {
+        return MaxSpinSeconds;
+    }
+    // Spin through the late wake-ups of almost every sleep, the rest lands a little after the deadline
+    return std::clamp(m_SleepOvershoot.GetPercentile(0.95) / 1000.0, MinSpinSeconds, MaxSpinSeconds);
+}
+
+double FramePacer::GetLatestLatencyMs(PresentMode mode) const
+{
+    for (const ModeLatency& entry : m_Latency)
+    {
+        if (entry.mode == mode)
+        {
+            return entry.latency.GetLatest();
+        }
+    }
+    return 0.0;
+}
+
+void FramePacer::PrintReport(std::ostream& out) const
+{
+    if (m_Period > 0.0 && m_WakeError.GetCount() > 0)
+    {
+        out << "Frame pacing at " << GetFpsCap() << " fps: woke up " << m_WakeError.GetMean() << " ms after the deadline on average (p99 "
+            << m_WakeError.GetPercentile(0.99) << " ms), spinning the last " << GetSpinSeconds() * 1000.0 << " ms\n";
+    }
+    for (const ModeLatency& entry : m_Latency)
+    {
+        out << "Input to present, " << GetPresentModeName(entry.mode) << " (" << entry.latency.GetCount() << " frames):\n";
+        entry.latency.Print(out, "ms");
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <iosfwd>
+#include <string_view>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+#include "rolling-histogram.h"
+
+// Present modes the swapchain of a backend honors, Fifo first. The SwapChain API has no capability
+// query, so this follows what the backends implement: Vulkan and D3D12 have all three, Metal cannot
+// do Mailbox and GL and the browser only present in Fifo.
+std::vector<wgpu::PresentMode> GetSupportedPresentModes(wgpu::BackendType backendType);
+// "fifo", "mailbox" or "immediate", false for anything else
+bool ParsePresentMode(std::string_view name, wgpu::PresentMode& mode);
+const char* GetPresentModeName(wgpu::PresentMode mode);
+
+// Paces the windowed loop. With an FPS cap every frame gets a deadline one period after the last one.
+// The wait sleeps until shortly before it and spins on the clock for the rest, the spin margin grows
+// with how late the sleeps wake up on this system. Input is sampled after the wait, and the time from
+// that sample to the present is kept per present mode.
+class FramePacer
+{
+public:
+    using Clock = double (*)();
+    static constexpr double MinSpinSeconds = 0.0005;
+    static constexpr double MaxSpinSeconds = 0.004;
+
+    FramePacer() = default;
+    // fpsCap 0 leaves the pacing to the present mode
+    FramePacer(Clock clock, double fpsCap);
+
+    // Blocks until the next frame is due and returns the time it woke up
+    double WaitForNextFrame();
+    // Call right after polling the input of the frame about to be recorded
+    void MarkInputSampled();
+    // Call right after the frame with the last input sample was presented
+    void MarkPresented(wgpu::PresentMode mode);
+
+    double GetFpsCap() const { return m_Period > 0.0 ? 1.0 / m_Period : 0.0; }
+    double GetSpinSeconds() const;
+    // Input to present of the latest frame in the mode, 0 before the first one
+    double GetLatestLatencyMs(wgpu::PresentMode mode) const;
+    void PrintReport(std::ostream& out) const;
+
+private:
+    struct ModeLatency
+    {
+        wgpu::PresentMode mode;
+        RollingHistogram latency;
+    };
+
+    Clock m_Clock{nullptr};
+    double m_Period{};
+    double m_NextDeadline{-1.0};
+    double m_InputTime{-1.0};
+    // How late the sleeps and the whole waits ended, in milliseconds
+    RollingHistogram m_SleepOvershoot;
+    RollingHistogram m_WakeError;
+    std::vector<ModeLatency> m_Latency;
+};
@@ -0,0 +1,171 @@
+#include "frame-readback.h"
+#include "gpu-tracker.h"
+#include <algorithm>
+#include <thread>
+
+using namespace wgpu;
+
+void ReadbackFrame::Release() const
+{
+    owner->Recycle(slot);
+}
+
+void FrameReadback::Init(Device device, uint32_t width, uint32_t height, uint32_t ringSize, uint32_t mapLatency, FrameCallback onFrame)
+{
+    m_Device = device;
+    m_Width = width;
+    m_Height = height;
+    // copyTextureToBuffer wants rows aligned to 256 bytes
+    m_BytesPerRow = (width * 4 + 255) & ~255u;
+    m_MapLatency = mapLatency;
+    m_OnFrame = std::move(onFrame);
+
+    m_Slots.clear();
+    for (uint32_t i = 0; i < std::max(ringSize, 1u); ++i)
+    {
+        auto slot = std::make_unique<Slot>();
+        slot->owner = this;
+        slot->buffer = GpuTracker::CreateBuffer(device, BufferDescriptor
+        {{
+            .label = "Readback Buffer",
+            .usage = BufferUsage::CopyDst | BufferUsage::MapRead,
+            .size = static_cast<uint64_t>(m_BytesPerRow) * height,
+            .mappedAtCreation = false,
+        }}, GpuTracker::Category::Readback);
+        m_Slots.push_back(std::move(slot));
+    }
+    m_NextSlot = 0;
+}
+
+bool FrameReadback::EncodeCopy(CommandEncoder encoder, Texture texture, uint64_t frameNumber)
+{
+    Slot& slot = *m_Slots[m_NextSlot];
+    if (slot.state != SlotState::Free)
+    {
+        // The consumer is behind, skip this frame rather than wait for it
+        ++m_Dropped;
+        return false;
+    }
+
+    ImageCopyTexture source = Default;
+    source.texture = texture;
+    source.mipLevel = 0;
+    source.origin = { 0, 0, 0 };
+    source.aspect = TextureAspect::All;
+
+    ImageCopyBuffer destination = Default;
+    destination.buffer = slot.buffer;
+    destination.layout.offset = 0;
+    destination.layout.bytesPerRow = m_BytesPerRow;
+    destination.layout.rowsPerImage = m_Height;
+
+    encoder.copyTextureToBuffer(source, destination, Extent3D{{ m_Width, m_Height, 1 }});
+
+    slot.frameNumber = frameNumber;
+    slot.state = SlotState::Copied;
+    m_NextSlot = (m_NextSlot + 1) % static_cast<uint32_t>(m_Slots.size());
+    ++m_Captured;
+    return true;
+}
+
+void FrameReadback::Poll(uint64_t frameNumber)
+{
+    const uint32_t count = static_cast<uint32_t>(m_Slots.size());
+
+    // Walk from the oldest slot so frames are delivered in the order they were rendered
+    bool inOrder = true;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Slot& slot = *m_Slots[(m_NextSlot + i) % count];
+        SlotState state = slot.state;
+
+        if (state == SlotState::Consumed)
+        {
+            slot.buffer.unmap();
+            slot.state = SlotState::Free;
+        }
+        else if (state == SlotState::Copied && frameNumber >= slot.frameNumber + m_MapLatency)
+        {
+            StartMapping(slot);
+            state = slot.state;
+        }
+
+        if (state == SlotState::Mapped && inOrder)
+        {
+            ReadbackFrame frame;
+            frame.frameNumber = slot.frameNumber;
+            frame.width = m_Width;
+            frame.height = m_Height;
+            frame.bytesPerRow = m_BytesPerRow;
+            frame.data = static_cast<const uint8_t*>(slot.buffer.getConstMappedRange(0, static_cast<size_t>(m_BytesPerRow) * m_Height));
+            frame.owner = this;
+            frame.slot = static_cast<uint32_t>((m_NextSlot + i) % count);
+
+            slot.state = SlotState::Delivered;
+            m_OnFrame(frame);
+        }
+        else if (state == SlotState::Copied || state == SlotState::Mapping)
+        {
+            inOrder = false;
+        }
+    }
+}
+
+void FrameReadback::Flush()
+{
+    for (auto& slot : m_Slots)
+    {
+        if (slot->state == SlotState::Copied)
+        {
+            StartMapping(*slot);
+        }
+    }
+
+    while (!IsIdle())
+    {
+#ifdef WEBGPU_BACKEND_DAWN
+        m_Device.tick();
+#endif
+        Poll(UINT64_MAX - m_MapLatency);
+        std::this_thread::yield();
+    }
+}
+
+void FrameReadback::Release()
+{
+    for (auto& slot : m_Slots)
+    {
+        GpuTracker::Release(slot->buffer);
+    }
+    m_Slots.clear();
+}
+
+void FrameReadback::Recycle(uint32_t slot)
+{
+    // Unmapping happens on the device thread, in the next Poll()
+    m_Slots[slot]->state = SlotState::Consumed;
+}
+
+void FrameReadback::StartMapping(Slot& slot)
+{
+    slot.state = SlotState::Mapping;
+
+    auto onMapped = [](WGPUBufferMapAsyncStatus status, void* pUserData) {
+        Slot& slot = *reinterpret_cast<Slot*>(pUserData);
+        if (status == WGPUBufferMapAsyncStatus_Success)
+        {
+            slot.state = SlotState::Mapped;
+        }
+        else
+        {
+            ++slot.owner->m_Dropped;
+            slot.state = SlotState::Free;
+        }
+    };
+    wgpuBufferMapAsync(slot.buffer, WGPUMapMode_Read, 0, static_cast<size_t>(m_BytesPerRow) * m_Height, onMapped, &slot);
+}
+
+bool FrameReadback::IsIdle() const
+{
+    return std::all_of(m_Slots.begin(), m_Slots.end(), [](const auto& slot) { return slot->state == SlotState::Free; });
+}
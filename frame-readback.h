@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+
+class FrameReadback;
+
+// A captured frame, still living in a mapped MapRead buffer. Rows are bytesPerRow apart
+// (padded to 256 bytes). Release() hands the buffer back to the ring, from any thread.
+struct ReadbackFrame
+{
+    uint64_t frameNumber{};
+    uint32_t width{};
+    uint32_t height{};
+    uint32_t bytesPerRow{};
+    const uint8_t* data{};
+
+    void Release() const;
+
+    FrameReadback* owner{};
+    uint32_t slot{};
+};
+
+// Ring of MapRead buffers the rendered texture is copied into. A buffer is only mapped a few
+// frames after its copy was submitted and its mapAsync is never waited on, so reading frames
+// back does not stall the pipeline. When every buffer is busy the frame is skipped instead.
+class FrameReadback
+{
+public:
+    using FrameCallback = std::function<void(const ReadbackFrame&)>;
+
+    void Init(wgpu::Device device, uint32_t width, uint32_t height, uint32_t ringSize, uint32_t mapLatency, FrameCallback onFrame);
+    // Records the copy of the BGRA8 texture, returns false when the frame had to be dropped.
+    bool EncodeCopy(wgpu::CommandEncoder encoder, wgpu::Texture texture, uint64_t frameNumber);
+    // Call once per frame after submitting: starts due mappings, delivers mapped frames and recycles released buffers.
+    void Poll(uint64_t frameNumber);
+    // Maps everything still pending and waits until all of it was delivered and released.
+    void Flush();
+    void Release();
+
+    uint64_t GetCapturedCount() const { return m_Captured; }
+    uint64_t GetDroppedCount() const { return m_Dropped; }
+
+private:
+    friend struct ReadbackFrame;
+
+    enum class SlotState
+    {
+        Free,
+        Copied,
+        Mapping,
+        Mapped,
+        Delivered,
+        Consumed,
+    };
+
+    struct Slot
+    {
+        wgpu::Buffer buffer{nullptr};
+        uint64_t frameNumber{};
+        std::atomic<SlotState> state{SlotState::Free};
+        FrameReadback* owner{};
+    };
+
+    void Recycle(uint32_t slot);
+    void StartMapping(Slot& slot);
+    bool IsIdle() const;
+
+    wgpu::Device m_Device{nullptr};
+    uint32_t m_Width{};
+    uint32_t m_Height{};
+    uint32_t m_BytesPerRow{};
+    uint32_t m_MapLatency{};
+    FrameCallback m_OnFrame;
+    std::vector<std::unique_ptr<Slot>> m_Slots;
+    uint32_t m_NextSlot{};
+
+    uint64_t m_Captured{};
+    uint64_t m_Dropped{};
+};
@@ -0,0 +1,60 @@
+#include "frame-stats.h"
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+
+FrameStats::FrameStats(size_t windowSize)
+    : m_FrameTime(windowSize)
+    , m_FrameDelta(windowSize)
+    , m_CpuEncode(windowSize)
+    , m_PresentWait(windowSize)
+    , m_GpuTime(windowSize)
+{
+}
+
+void FrameStats::BeginFrame(double nowSeconds)
+{
+    if (m_LastFrameStart >= 0.0)
+    {
+        const double frameMs = (nowSeconds - m_LastFrameStart) * 1000.0;
+        if (m_FrameTime.GetCount() > 0)
+        {
+            m_FrameDelta.Add(std::abs(frameMs - m_FrameTime.GetLatest()));
+        }
+        m_FrameTime.Add(frameMs);
+    }
+    m_LastFrameStart = nowSeconds;
+    ++m_FrameCount;
+}
+
+std::string FrameStats::FormatSummary() const
+{
+    const double p50 = m_FrameTime.GetPercentile(0.5);
+    char text[160];
+    int length = std::snprintf(text, sizeof(text), "%.1f fps | %.2f ms p50 %.2f p95 %.2f p99 | jitter %.2f | cpu %.2f",
+        p50 > 0.0 ? 1000.0 / p50 : 0.0, p50, m_FrameTime.GetPercentile(0.95), m_FrameTime.GetPercentile(0.99),
+        GetJitterMs(), m_CpuEncode.GetPercentile(0.5));
+    if (m_GpuTime.GetCount() > 0 && length > 0 && length < static_cast<int>(sizeof(text)))
+    {
+        std::snprintf(text + length, sizeof(text) - length, " | gpu %.2f", m_GpuTime.GetPercentile(0.5));
+    }
+    return text;
+}
+
+void FrameStats::PrintReport(std::ostream& out) const
+{
+    out << "Frame time (jitter " << GetJitterMs() << " ms):\n";
+    m_FrameTime.Print(out, "ms");
+    out << "CPU encode:\n";
+    m_CpuEncode.Print(out, "ms");
+    if (m_PresentWait.GetCount() > 0)
+    {
+        out << "Present wait:\n";
+        m_PresentWait.Print(out, "ms");
+    }
+    if (m_GpuTime.GetCount() > 0)
+    {
+        out << "GPU time:\n";
+        m_GpuTime.Print(out, "ms");
+    }
+}
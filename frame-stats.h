@@ -0,0 +1,44 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include "rolling-histogram.h"
+
+// Rolling frame timings in milliseconds: total frame time, CPU time spent encoding the frame,
+// time blocked in present and, when the GPU profiler runs, GPU time of the passes.
+class FrameStats
+{
+public:
+    static constexpr size_t WindowSize = 240;
+
+    // Benchmarks widen the window to the whole run so the percentiles cover every frame
+    explicit FrameStats(size_t windowSize = WindowSize);
+
+    // Call once at the start of every frame, the frame time is the distance between two calls
+    void BeginFrame(double nowSeconds);
+    void RecordCpuEncode(double ms) { m_CpuEncode.Add(ms); }
+    void RecordPresentWait(double ms) { m_PresentWait.Add(ms); }
+    void RecordGpuTime(double ms) { m_GpuTime.Add(ms); }
+
+    const RollingHistogram& GetFrameTimes() const { return m_FrameTime; }
+    const RollingHistogram& GetCpuEncodeTimes() const { return m_CpuEncode; }
+    const RollingHistogram& GetPresentWaits() const { return m_PresentWait; }
+    const RollingHistogram& GetGpuTimes() const { return m_GpuTime; }
+    // Mean absolute change between consecutive frame times
+    double GetJitterMs() const { return m_FrameDelta.GetMean(); }
+    uint64_t GetFrameCount() const { return m_FrameCount; }
+
+    // Short one-line readout, for a window title or a log line
+    std::string FormatSummary() const;
+    void PrintReport(std::ostream& out) const;
+
+private:
+    RollingHistogram m_FrameTime;
+    RollingHistogram m_FrameDelta;
+    RollingHistogram m_CpuEncode;
+    RollingHistogram m_PresentWait;
+    RollingHistogram m_GpuTime;
+
+    double m_LastFrameStart{-1.0};
+    uint64_t m_FrameCount{};
+};
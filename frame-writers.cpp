@@ -0,0 +1,191 @@
+#include "frame-writers.h"
+#include "cpu-profiler.h"
+#include <algorithm>
+#include <iostream>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "glfw/deps/stb_image_write.h"
+
+FrameWriter::~FrameWriter()
+{
+    if (m_Thread.joinable())
+    {
+        std::cerr << "FrameWriter destroyed without Stop()" << std::endl;
+        std::terminate();
+    }
+}
+
+void FrameWriter::Start()
+{
+    m_Stopping = false;
+    m_Thread = std::thread(&FrameWriter::WorkerLoop, this);
+}
+
+void FrameWriter::Submit(const ReadbackFrame& frame)
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Queue.push_back(frame);
+    }
+    m_Condition.notify_one();
+}
+
+void FrameWriter::Stop()
+{
+    if (!m_Thread.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_Condition.notify_one();
+    m_Thread.join();
+}
+
+void FrameWriter::WorkerLoop()
+{
+    CpuProfiler::SetThreadName("Frame Writer");
+    while (true)
+    {
+        ReadbackFrame frame;
+        {
+            std::unique_lock lock(m_Mutex);
+            m_Condition.wait(lock, [this] { return m_Stopping || !m_Queue.empty(); });
+            if (m_Queue.empty())
+            {
+                return;
+            }
+            frame = m_Queue.front();
+            m_Queue.pop_front();
+        }
+
+        PROFILE_ZONE("FrameWriter::Write");
+        if (Write(frame))
+        {
+            ++m_Written;
+        }
+        frame.Release();
+    }
+}
+
+PngWriter::PngWriter(std::filesystem::path directory)
+    : m_Directory(std::move(directory))
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_Directory, error);
+}
+
+bool PngWriter::Write(const ReadbackFrame& frame)
+{
+    // The swapchain format is BGRA, PNG wants RGBA without the row padding
+    m_Rgba.resize(static_cast<size_t>(frame.width) * frame.height * 4);
+    for (uint32_t y = 0; y < frame.height; ++y)
+    {
+        const uint8_t* source = frame.data + static_cast<size_t>(y) * frame.bytesPerRow;
+        uint8_t* destination = m_Rgba.data() + static_cast<size_t>(y) * frame.width * 4;
+        for (uint32_t x = 0; x < frame.width; ++x)
+        {
+            destination[x * 4 + 0] = source[x * 4 + 2];
+            destination[x * 4 + 1] = source[x * 4 + 1];
+            destination[x * 4 + 2] = source[x * 4 + 0];
+            destination[x * 4 + 3] = source[x * 4 + 3];
+        }
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%06llu.png", static_cast<unsigned long long>(frame.frameNumber));
+    const std::string path = (m_Directory / name).string();
+
+    const int width = static_cast<int>(frame.width);
+    if (!stbi_write_png(path.c_str(), width, static_cast<int>(frame.height), 4, m_Rgba.data(), width * 4))
+    {
+        std::cerr << "Could not write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+RawVideoWriter::RawVideoWriter(const std::filesystem::path& path, Format format, uint32_t frameRateNumerator, uint32_t frameRateDenominator)
+    : m_Format(format)
+    , m_FrameRateNumerator(frameRateNumerator)
+    , m_FrameRateDenominator(frameRateDenominator)
+{
+    m_File = std::fopen(path.string().c_str(), "wb");
+    if (!m_File)
+    {
+        std::cerr << "Could not open " << path << " for writing" << std::endl;
+    }
+}
+
+RawVideoWriter::~RawVideoWriter()
+{
+    if (m_File)
+    {
+        std::fclose(m_File);
+    }
+}
+
+bool RawVideoWriter::Write(const ReadbackFrame& frame)
+{
+    if (!m_File)
+    {
+        return false;
+    }
+    if (m_Format == Format::Y4m)
+    {
+        return WriteY4mFrame(frame);
+    }
+
+    // Raw BGRA goes out of the mapped buffer as is, only the row padding is skipped
+    const size_t rowSize = static_cast<size_t>(frame.width) * 4;
+    if (rowSize == frame.bytesPerRow)
+    {
+        return std::fwrite(frame.data, rowSize * frame.height, 1, m_File) == 1;
+    }
+    for (uint32_t y = 0; y < frame.height; ++y)
+    {
+        if (std::fwrite(frame.data + static_cast<size_t>(y) * frame.bytesPerRow, rowSize, 1, m_File) != 1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RawVideoWriter::WriteY4mFrame(const ReadbackFrame& frame)
+{
+    if (!m_HeaderWritten)
+    {
+        // Readers assume limited range without the tag and would crush the blacks and whites
+        std::fprintf(m_File, "YUV4MPEG2 W%u H%u F%u:%u Ip A1:1 C444 XCOLORRANGE=FULL\n",
+            frame.width, frame.height, m_FrameRateNumerator, m_FrameRateDenominator);
+        m_HeaderWritten = true;
+    }
+
+    // Full range BT.601, one Y, U and V sample per pixel
+    const size_t pixels = static_cast<size_t>(frame.width) * frame.height;
+    m_Planes.resize(pixels * 3);
+    uint8_t* yPlane = m_Planes.data();
+    uint8_t* uPlane = yPlane + pixels;
+    uint8_t* vPlane = uPlane + pixels;
+
+    auto toByte = [](float value) { return static_cast<uint8_t>(std::clamp(value + 0.5f, 0.0f, 255.0f)); };
+    for (uint32_t y = 0; y < frame.height; ++y)
+    {
+        const uint8_t* row = frame.data + static_cast<size_t>(y) * frame.bytesPerRow;
+        for (uint32_t x = 0; x < frame.width; ++x)
+        {
+            const float b = row[x * 4 + 0];
+            const float g = row[x * 4 + 1];
+            const float r = row[x * 4 + 2];
+            const size_t i = static_cast<size_t>(y) * frame.width + x;
+            yPlane[i] = toByte(0.299f * r + 0.587f * g + 0.114f * b);
+            uPlane[i] = toByte(-0.168736f * r - 0.331264f * g + 0.5f * b + 128.0f);
+            vPlane[i] = toByte(0.5f * r - 0.418688f * g - 0.081312f * b + 128.0f);
+        }
+    }
+
+    return std::fputs("FRAME\n", m_File) >= 0 && std::fwrite(m_Planes.data(), m_Planes.size(), 1, m_File) == 1;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "frame-readback.h"
+
+// Writes read back frames on a worker thread. Frames are queued while still mapped and released
+// back to the readback ring once written, so the queue can never grow past the ring size.
+class FrameWriter
+{
+public:
+    virtual ~FrameWriter();
+
+    void Start();
+    void Submit(const ReadbackFrame& frame);
+    // Writes whatever is still queued and joins the worker. Must run before the writer is destroyed.
+    void Stop();
+
+    uint64_t GetWrittenCount() const { return m_Written; }
+
+protected:
+    virtual bool Write(const ReadbackFrame& frame) = 0;
+
+private:
+    void WorkerLoop();
+
+    std::thread m_Thread;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::deque<ReadbackFrame> m_Queue;
+    bool m_Stopping{false};
+    std::atomic<uint64_t> m_Written{0};
+};
+
+// One PNG per frame, for golden-image comparisons.
+class PngWriter : public FrameWriter
+{
+public:
+    explicit PngWriter(std::filesystem::path directory);
+
+protected:
+    bool Write(const ReadbackFrame& frame) override;
+
+private:
+    std::filesystem::path m_Directory;
+    std::vector<uint8_t> m_Rgba;
+};
+
+// Appends frames to one file (or named pipe) for long soak runs: tightly packed BGRA straight from
+// the mapped buffer, or Y4M (4:4:4) that video tools can open directly.
+class RawVideoWriter : public FrameWriter
+{
+public:
+    enum class Format
+    {
+        Bgra,
+        Y4m,
+    };
+
+    // The frame rate is a ratio so every capture interval keeps its exact rate, 60:7 for instance
+    RawVideoWriter(const std::filesystem::path& path, Format format, uint32_t frameRateNumerator, uint32_t frameRateDenominator);
+    ~RawVideoWriter() override;
+
+    bool IsOpen() const { return m_File != nullptr; }
+
+protected:
+    bool Write(const ReadbackFrame& frame) override;
+
+private:
+    bool WriteY4mFrame(const ReadbackFrame& frame);
+
+    std::FILE* m_File{};
+    Format m_Format;
+    uint32_t m_FrameRateNumerator;
+    uint32_t m_FrameRateDenominator;
+    bool m_HeaderWritten{false};
+    std::vector<uint8_t> m_Planes;
+};
@@ -0,0 +1,277 @@
+#include "gpu-driven.h"
+#include "cpu-profiler.h"
+#include "gpu-tracker.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace wgpu;
+
+bool GpuDrivenRenderer::Init(Device device, ShaderModule cullShader, ShaderModule drawShader,
+                             TextureFormat colorFormat, TextureFormat depthFormat, uint32_t sampleCount, const Mesh& mesh, uint32_t objectCount)
+{
+    PROFILE_FUNCTION();
+    if (!cullShader || !drawShader)
+    {
+        std::cerr << "GPU-driven path is missing its shaders" << std::endl;
+        return false;
+    }
+
+    m_Mesh = mesh;
+    m_ObjectCount = objectCount;
+
+    // Lay the objects out on a grid about four screens wide, so the camera only ever sees part of it
+    const uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(objectCount))));
+    const float spacing = 8.0f / static_cast<float>(columns);
+    const float scale = spacing * 0.5f;
+
+    std::vector<ObjectData> objects(objectCount);
+    for (uint32_t i = 0; i < objectCount; ++i)
+    {
+        const float x = -4.0f + spacing * static_cast<float>(i % columns);
+        const float y = -4.0f + spacing * static_cast<float>(i / columns);
+        const float shade = 0.4f + 0.6f * static_cast<float>(i % 7) / 6.0f;
+        // Neighbours that overlap resolve by depth instead of by the order the culling appended them
+        const float depth = 0.1f + 0.8f * static_cast<float>(i % 7) / 6.0f;
+
+        objects[i].placement = { x, y, scale, depth };
+        objects[i].color = { shade, 1.0f, 1.0f - shade * 0.5f, 1.0f };
+        objects[i].bounds = {
+            x + mesh.bounds[0] * scale,
+            y + mesh.bounds[1] * scale,
+            0.0f,
+            mesh.bounds[2] * scale,
+        };
+    }
+
+    m_UniformBuffer = GpuTracker::CreateBuffer(device, BufferDescriptor
+    {{
+        .label = "Cull Uniforms",
+        .usage = BufferUsage::CopyDst | BufferUsage::Uniform,
+        .size = sizeof(CullUniforms),
+        .mappedAtCreation = false,
+    }}, GpuTracker::Category::Uniform);
+
+    m_ObjectBuffer = GpuTracker::CreateBuffer(device, BufferDescriptor
+    {{
+        .label = "Objects",
+        .usage = BufferUsage::CopyDst | BufferUsage::Storage,
+        .size = objects.size() * sizeof(ObjectData),
+        .mappedAtCreation = false,
+    }}, GpuTracker::Category::Storage);
+    Queue queue = device.getQueue();
+    queue.writeBuffer(m_ObjectBuffer, 0, objects.data(), objects.size() * sizeof(ObjectData));
+    queue.release();
+
+    m_DrawArgsBuffer = GpuTracker::CreateBuffer(device, BufferDescriptor
+    {{
+        .label = "Draw Args",
+        .usage = BufferUsage::CopyDst | BufferUsage::Storage | BufferUsage::Indirect,
+        .size = sizeof(DrawIndexedArgs),
+        .mappedAtCreation = false,
+    }}, GpuTracker::Category::Indirect);
+
+    m_VisibleBuffer = GpuTracker::CreateBuffer(device, BufferDescriptor
+    {{
+        .label = "Visible Objects",
+        .usage = BufferUsage::Storage,
+        .size = objectCount * sizeof(uint32_t),
+        .mappedAtCreation = false,
+    }}, GpuTracker::Category::Storage);
+
+    // Both pipelines use the automatic layout, the bind groups are built from what the shaders declare
+    m_CullPipeline = GpuTracker::CreateComputePipeline(device, ComputePipelineDescriptor
+    {{
+        .label = "Cull Pipeline",
+        .layout = nullptr,
+        .compute = ProgrammableStageDescriptor
+        {{
+            .module = cullShader,
+            .entryPoint = "cs_cull",
+            .constantCount = 0,
+            .constants = nullptr,
+        }},
+    }});
+
+    std::vector vertexAttributes{
+        VertexAttribute{{ .format = VertexFormat::Float32x2, .offset = 0, .shaderLocation = 0 }},
+        VertexAttribute{{ .format = VertexFormat::Float32x3, .offset = 2 * sizeof(float), .shaderLocation = 1 }},
+    };
+    VertexBufferLayout vertexBufferLayout
+    {{
+        .arrayStride = 5 * sizeof(float),
+        .stepMode = VertexStepMode::Vertex,
+        .attributeCount = static_cast<uint32_t>(vertexAttributes.size()),
+        .attributes = vertexAttributes.data(),
+    }};
+
+    ColorTargetState colorTarget
+    {{
+        .format = colorFormat,
+        .blend = nullptr,
+        .writeMask = ColorWriteMask::All
+    }};
+    FragmentState fragmentState
+    {{
+        .module = drawShader,
+        .entryPoint = "fs_main",
+        .constantCount = 0,
+        .constants = nullptr,
+        .targetCount = 1,
+        .targets = &colorTarget
+    }};
+
+    DepthStencilState depthStencilState = Default;
+    depthStencilState.format = depthFormat;
+    depthStencilState.depthWriteEnabled = true;
+    depthStencilState.depthCompare = CompareFunction::Less;
+    depthStencilState.stencilReadMask = 0;
+    depthStencilState.stencilWriteMask = 0;
+
+    m_DrawPipeline = GpuTracker::CreateRenderPipeline(device, RenderPipelineDescriptor
+    {{
+        .label = "GPU Driven Pipeline",
+        .layout = nullptr,
+        .vertex = VertexState
+        {{
+            .module = drawShader,
+            .entryPoint = "vs_main",
+            .constantCount = 0,
+            .constants = nullptr,
+            .bufferCount = 1,
+            .buffers = &vertexBufferLayout,
+        }},
+        .primitive = PrimitiveState
+        {{
+            .topology = PrimitiveTopology::TriangleList,
+            .stripIndexFormat = IndexFormat::Undefined,
+            .frontFace = FrontFace::CCW,
+            .cullMode = CullMode::None
+        }},
+        .depthStencil = depthFormat != TextureFormat::Undefined ? &depthStencilState : nullptr,
+        .multisample = MultisampleState{{.count = sampleCount, .mask = ~0u, .alphaToCoverageEnabled = false}},
+        .fragment = &fragmentState,
+    }});
+
+    std::vector cullEntries{
+        BindGroupEntry{{ .binding = 0, .buffer = m_UniformBuffer, .offset = 0, .size = sizeof(CullUniforms) }},
+        BindGroupEntry{{ .binding = 1, .buffer = m_ObjectBuffer, .offset = 0, .size = objectCount * sizeof(ObjectData) }},
+        BindGroupEntry{{ .binding = 2, .buffer = m_DrawArgsBuffer, .offset = 0, .size = sizeof(DrawIndexedArgs) }},
+        BindGroupEntry{{ .binding = 3, .buffer = m_VisibleBuffer, .offset = 0, .size = objectCount * sizeof(uint32_t) }},
+    };
+    BindGroupLayout cullLayout = m_CullPipeline.getBindGroupLayout(0);
+    m_CullBindGroup = GpuTracker::CreateBindGroup(device, BindGroupDescriptor
+    {{
+        .label = "Cull Bind Group",
+        .layout = cullLayout,
+        .entryCount = static_cast<uint32_t>(cullEntries.size()),
+        .entries = cullEntries.data(),
+    }});
+    cullLayout.release();
+
+    std::vector drawEntries{
+        BindGroupEntry{{ .binding = 0, .buffer = m_UniformBuffer, .offset = 0, .size = sizeof(CullUniforms) }},
+        BindGroupEntry{{ .binding = 1, .buffer = m_ObjectBuffer, .offset = 0, .size = objectCount * sizeof(ObjectData) }},
+        BindGroupEntry{{ .binding = 2, .buffer = m_VisibleBuffer, .offset = 0, .size = objectCount * sizeof(uint32_t) }},
+    };
+    BindGroupLayout drawLayout = m_DrawPipeline.getBindGroupLayout(0);
+    m_DrawBindGroup = GpuTracker::CreateBindGroup(device, BindGroupDescriptor
+    {{
+        .label = "GPU Driven Bind Group",
+        .layout = drawLayout,
+        .entryCount = static_cast<uint32_t>(drawEntries.size()),
+        .entries = drawEntries.data(),
+    }});
+    drawLayout.release();
+
+    return m_CullPipeline && m_DrawPipeline;
+}
+
+void GpuDrivenRenderer::Update(StagingBelt& belt, Queue queue, CommandEncoder encoder, float time, float aspectRatio)
+{
+    // Pan the camera in a slow circle over the grid
+    const float zoom = 0.75f;
+    const float cameraX = 2.0f * std::cos(time * 0.25f);
+    const float cameraY = 2.0f * std::sin(time * 0.25f);
+    const float halfWidth = 1.0f / zoom;
+    const float halfHeight = 1.0f / (zoom * aspectRatio);
+
+    CullUniforms uniforms{};
+    uniforms.planes = {{
+        { 1.0f, 0.0f, 0.0f, halfWidth - cameraX },
+        { -1.0f, 0.0f, 0.0f, halfWidth + cameraX },
+        { 0.0f, 1.0f, 0.0f, halfHeight - cameraY },
+        { 0.0f, -1.0f, 0.0f, halfHeight + cameraY },
+    }};
+    uniforms.camera = { cameraX, cameraY, zoom, aspectRatio };
+    uniforms.objectCount = m_ObjectCount;
+    if (!belt.Write(encoder, m_UniformBuffer, 0, &uniforms, sizeof(CullUniforms)))
+    {
+        queue.writeBuffer(m_UniformBuffer, 0, &uniforms, sizeof(CullUniforms));
+    }
+
+    // The cull pass counts the instances up from zero every frame
+    const DrawIndexedArgs args{ m_Mesh.indexCount, 0, m_Mesh.firstIndex, m_Mesh.baseVertex, 0 };
+    if (!belt.Write(encoder, m_DrawArgsBuffer, 0, &args, sizeof(DrawIndexedArgs)))
+    {
+        queue.writeBuffer(m_DrawArgsBuffer, 0, &args, sizeof(DrawIndexedArgs));
+    }
+}
+
+void GpuDrivenRenderer::EncodeCulling(CommandEncoder encoder, const WGPUComputePassTimestampWrites* timestampWrites) const
+{
+    ComputePassEncoder computePass = encoder.beginComputePass(ComputePassDescriptor
+    {{
+        .label = "Cull Pass",
+        .timestampWrites = timestampWrites,
+    }});
+    computePass.setPipeline(m_CullPipeline);
+    computePass.setBindGroup(0, m_CullBindGroup, 0, nullptr);
+    computePass.dispatchWorkgroups((m_ObjectCount + WorkgroupSize - 1) / WorkgroupSize, 1, 1);
+    computePass.end();
+    computePass.release();
+}
+
+void GpuDrivenRenderer::Draw(RenderPassEncoder renderPass) const
+{
+    renderPass.setPipeline(m_DrawPipeline);
+    renderPass.setVertexBuffer(0, m_Mesh.vertexBuffer, 0, m_Mesh.vertexBufferSize);
+    renderPass.setIndexBuffer(m_Mesh.indexBuffer, IndexFormat::Uint16, 0, m_Mesh.indexBufferSize);
+    renderPass.setBindGroup(0, m_DrawBindGroup, 0, nullptr);
+    renderPass.drawIndexedIndirect(m_DrawArgsBuffer, 0);
+}
+
+void GpuDrivenRenderer::Release()
+{
+    GpuTracker::Release(m_DrawBindGroup);
+    GpuTracker::Release(m_CullBindGroup);
+    GpuTracker::Release(m_DrawPipeline);
+    GpuTracker::Release(m_CullPipeline);
+    for (Buffer* buffer : { &m_UniformBuffer, &m_ObjectBuffer, &m_DrawArgsBuffer, &m_VisibleBuffer })
+    {
+        GpuTracker::Release(*buffer);
+    }
+}
+
+std::array<float, 3> GpuDrivenRenderer::ComputeMeshBounds(const std::vector<float>& pointData, uint32_t floatsPerVertex)
+{
+    float minX = 0.0f, minY = 0.0f, maxX = 0.0f, maxY = 0.0f;
+    for (size_t i = 0; i + 1 < pointData.size(); i += floatsPerVertex)
+    {
+        const float x = pointData[i];
+        const float y = pointData[i + 1];
+        if (i == 0 || x < minX) minX = x;
+        if (i == 0 || y < minY) minY = y;
+        if (i == 0 || x > maxX) maxX = x;
+        if (i == 0 || y > maxY) maxY = y;
+    }
+
+    const float centerX = (minX + maxX) * 0.5f;
+    const float centerY = (minY + maxY) * 0.5f;
+    float radius = 0.0f;
+    for (size_t i = 0; i + 1 < pointData.size(); i += floatsPerVertex)
+    {
+        radius = std::max(radius, std::hypot(pointData[i] - centerX, pointData[i + 1] - centerY));
+    }
+    return { centerX, centerY, radius };
+}
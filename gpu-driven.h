@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+#include "staging-belt.h"
+
+// GPU-driven path: object bounds and the drawIndexedIndirect arguments live in storage buffers.
+// A compute pass frustum culls every object and appends the visible ones to a compacted list,
+// counting them into the instanceCount of one indirect draw. The CPU records the same handful of
+// commands whatever the number of objects.
+class GpuDrivenRenderer
+{
+public:
+    struct Mesh
+    {
+        wgpu::Buffer vertexBuffer{nullptr};
+        uint64_t vertexBufferSize{};
+        wgpu::Buffer indexBuffer{nullptr};
+        uint64_t indexBufferSize{};
+        uint32_t indexCount{};
+        // Where the mesh starts when it shares its buffers with others
+        uint32_t firstIndex{};
+        int32_t baseVertex{};
+        // Bounding circle of the mesh in model space: x, y, radius
+        std::array<float, 3> bounds{};
+    };
+
+    bool Init(wgpu::Device device, wgpu::ShaderModule cullShader, wgpu::ShaderModule drawShader,
+              wgpu::TextureFormat colorFormat, wgpu::TextureFormat depthFormat, uint32_t sampleCount, const Mesh& mesh, uint32_t objectCount);
+    // Moves the camera and resets the indirect arguments, recorded into the encoder ahead of the culling.
+    // Whatever the belt has no space for goes through the queue, a stale instance count would overrun.
+    void Update(StagingBelt& belt, wgpu::Queue queue, wgpu::CommandEncoder encoder, float time, float aspectRatio);
+    void EncodeCulling(wgpu::CommandEncoder encoder, const WGPUComputePassTimestampWrites* timestampWrites = nullptr) const;
+    void Draw(wgpu::RenderPassEncoder renderPass) const;
+    void Release();
+
+    uint32_t GetObjectCount() const { return m_ObjectCount; }
+    // Written by the culling, read by the indirect draw
+    wgpu::Buffer GetDrawArgsBuffer() const { return m_DrawArgsBuffer; }
+
+    // Sizes the device limits have to allow for
+    static uint64_t GetLargestBufferSize(uint32_t objectCount) { return objectCount * sizeof(ObjectData); }
+    static uint64_t GetUniformBufferSize() { return sizeof(CullUniforms); }
+    static constexpr uint32_t WorkgroupSize = 64;
+
+    static std::array<float, 3> ComputeMeshBounds(const std::vector<float>& pointData, uint32_t floatsPerVertex);
+
+private:
+    struct CullUniforms
+    {
+        std::array<std::array<float, 4>, 4> planes;
+        std::array<float, 4> camera;  // xy position, zoom, aspect ratio
+        uint32_t objectCount;
+        uint32_t _pad[3];
+    };
+
+    struct ObjectData
+    {
+        std::array<float, 4> placement;  // xy offset, scale, depth
+        std::array<float, 4> color;
+        std::array<float, 4> bounds;
+    };
+
+    struct DrawIndexedArgs
+    {
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t firstInstance;
+    };
+
+    Mesh m_Mesh;
+    uint32_t m_ObjectCount{};
+
+    wgpu::ComputePipeline m_CullPipeline{nullptr};
+    wgpu::RenderPipeline m_DrawPipeline{nullptr};
+    wgpu::Buffer m_UniformBuffer{nullptr};
+    wgpu::Buffer m_ObjectBuffer{nullptr};
+    wgpu::Buffer m_DrawArgsBuffer{nullptr};
+    wgpu::Buffer m_VisibleBuffer{nullptr};
+    wgpu::BindGroup m_CullBindGroup{nullptr};
+    wgpu::BindGroup m_DrawBindGroup{nullptr};
+};
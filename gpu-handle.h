@@ -0,0 +1,67 @@
+#pragma once
+
+#include <utility>
+#include <webgpu/webgpu.hpp>
+#include "gpu-tracker.h"
+
+// Releases a wgpu handle and resets it. Objects the tracker knows about go through
+// GpuTracker::Release, which also destroys buffers, textures and query sets.
+template<typename T>
+void ReleaseGpuObject(T& object)
+{
+    if constexpr (requires { GpuTracker::Release(object); })
+    {
+        GpuTracker::Release(object);
+    }
+    else if (object)
+    {
+        object.release();
+        object = nullptr;
+    }
+}
+
+// Move-only owner of one reference to a wgpu object, released when the owner goes out of scope.
+// Owners of globals must be reset explicitly before the device goes away.
+template<typename T>
+class GpuHandle
+{
+public:
+    GpuHandle() = default;
+    GpuHandle(std::nullptr_t) {}
+    explicit GpuHandle(T object) : m_Object(object) {}
+    ~GpuHandle() { Reset(); }
+
+    GpuHandle(GpuHandle&& other) noexcept : m_Object(other.Detach()) {}
+    GpuHandle& operator=(GpuHandle&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset(other.Detach());
+        }
+        return *this;
+    }
+    GpuHandle(const GpuHandle&) = delete;
+    GpuHandle& operator=(const GpuHandle&) = delete;
+
+    void Reset(T object = nullptr)
+    {
+        ReleaseGpuObject(m_Object);
+        m_Object = object;
+    }
+    // Gives up ownership without releasing
+    T Detach()
+    {
+        T object = m_Object;
+        m_Object = nullptr;
+        return object;
+    }
+
+    const T& Get() const { return m_Object; }
+    const T* operator->() const { return &m_Object; }
+    T* operator->() { return &m_Object; }
+    operator const T&() const { return m_Object; }
+    explicit operator bool() const { return static_cast<bool>(m_Object); }
+
+private:
+    T m_Object{nullptr};
+};
@@ -0,0 +1,223 @@
+#include "gpu-profiler.h"
+#include "gpu-tracker.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+using namespace wgpu;
+
+void GpuProfiler::Init(Device device, bool timestampsSupported, uint32_t ringSize)
+{
+    m_Device = device;
+    m_Enabled = timestampsSupported;
+    if (!m_Enabled)
+    {
+        std::cout << "TimestampQuery is not supported, GPU pass timings are disabled" << std::endl;
+        return;
+    }
+
+    ringSize = std::max(ringSize, 1u);
+    m_QuerySet = GpuTracker::CreateQuerySet(device, QuerySetDescriptor
+    {{
+        .label = "Pass Timestamps",
+        .type = QueryType::Timestamp,
+        .count = ringSize * MaxPassesPerFrame * 2,
+    }});
+
+    // resolveQuerySet wants its destination offset aligned to 256 bytes, every frame gets its own stride
+    m_ResolveBuffer = GpuTracker::CreateBuffer(device, BufferDescriptor
+    {{
+        .label = "Timestamp Resolve",
+        .usage = BufferUsage::QueryResolve | BufferUsage::CopySrc,
+        .size = ringSize * ResolveStride,
+        .mappedAtCreation = false,
+    }}, GpuTracker::Category::Query);
+
+    m_Slots.clear();
+    for (uint32_t i = 0; i < ringSize; ++i)
+    {
+        auto slot = std::make_unique<Slot>();
+        slot->readback = GpuTracker::CreateBuffer(device, BufferDescriptor
+        {{
+            .label = "Timestamp Readback",
+            .usage = BufferUsage::CopyDst | BufferUsage::MapRead,
+            .size = MaxPassesPerFrame * 2 * sizeof(uint64_t),
+            .mappedAtCreation = false,
+        }}, GpuTracker::Category::Readback);
+        m_Slots.push_back(std::move(slot));
+    }
+}
+
+void GpuProfiler::BeginFrame()
+{
+    m_Recording = false;
+    if (!m_Enabled)
+    {
+        return;
+    }
+
+    m_CurrentSlot = static_cast<uint32_t>(m_FrameNumber++ % m_Slots.size());
+    Slot& slot = *m_Slots[m_CurrentSlot];
+    if (slot.state != SlotState::Free)
+    {
+        // The results of this slot are not back yet, leave this frame untimed rather than wait
+        return;
+    }
+    slot.passCount = 0;
+    slot.state = SlotState::Recording;
+    m_Recording = true;
+}
+
+const WGPURenderPassTimestampWrites* GpuProfiler::BeginRenderPass(const char* name)
+{
+    const uint32_t pass = AllocatePass(name);
+    if (pass == MaxPassesPerFrame)
+    {
+        return nullptr;
+    }
+    const uint32_t firstQuery = (m_CurrentSlot * MaxPassesPerFrame + pass) * 2;
+    m_RenderWrites[pass] = { m_QuerySet, firstQuery, firstQuery + 1 };
+    return &m_RenderWrites[pass];
+}
+
+const WGPUComputePassTimestampWrites* GpuProfiler::BeginComputePass(const char* name)
+{
+    const uint32_t pass = AllocatePass(name);
+    if (pass == MaxPassesPerFrame)
+    {
+        return nullptr;
+    }
+    const uint32_t firstQuery = (m_CurrentSlot * MaxPassesPerFrame + pass) * 2;
+    m_ComputeWrites[pass] = { m_QuerySet, firstQuery, firstQuery + 1 };
+    return &m_ComputeWrites[pass];
+}
+
+void GpuProfiler::EndFrame(CommandEncoder encoder)
+{
+    if (!m_Recording)
+    {
+        return;
+    }
+    m_Recording = false;
+
+    Slot& slot = *m_Slots[m_CurrentSlot];
+    if (slot.passCount == 0)
+    {
+        slot.state = SlotState::Free;
+        return;
+    }
+
+    const uint32_t queryCount = slot.passCount * 2;
+    encoder.resolveQuerySet(m_QuerySet, m_CurrentSlot * MaxPassesPerFrame * 2, queryCount, m_ResolveBuffer, m_CurrentSlot * ResolveStride);
+    encoder.copyBufferToBuffer(m_ResolveBuffer, m_CurrentSlot * ResolveStride, slot.readback, 0, queryCount * sizeof(uint64_t));
+    slot.state = SlotState::Resolved;
+}
+
+bool GpuProfiler::Poll()
+{
+    bool collected = false;
+    for (auto& slotPtr : m_Slots)
+    {
+        Slot& slot = *slotPtr;
+        if (slot.state == SlotState::Resolved)
+        {
+            slot.state = SlotState::Mapping;
+            auto onMapped = [](WGPUBufferMapAsyncStatus status, void* pUserData) {
+                Slot& slot = *reinterpret_cast<Slot*>(pUserData);
+                slot.state = status == WGPUBufferMapAsyncStatus_Success ? SlotState::Mapped : SlotState::Free;
+            };
+            wgpuBufferMapAsync(slot.readback, WGPUMapMode_Read, 0, slot.passCount * 2 * sizeof(uint64_t), onMapped, &slot);
+        }
+        else if (slot.state == SlotState::Mapped)
+        {
+            Collect(slot);
+            collected = true;
+        }
+    }
+    return collected;
+}
+
+void GpuProfiler::Release()
+{
+    auto isMapping = [](const std::unique_ptr<Slot>& slot) { return slot->state == SlotState::Mapping; };
+    while (std::any_of(m_Slots.begin(), m_Slots.end(), isMapping))
+    {
+#ifdef WEBGPU_BACKEND_DAWN
+        m_Device.tick();
+#endif
+        std::this_thread::yield();
+    }
+
+    for (auto& slot : m_Slots)
+    {
+        if (slot->state == SlotState::Mapped)
+        {
+            slot->readback.unmap();
+        }
+        GpuTracker::Release(slot->readback);
+    }
+    m_Slots.clear();
+    GpuTracker::Release(m_ResolveBuffer);
+    GpuTracker::Release(m_QuerySet);
+    m_Device = nullptr;
+    m_Enabled = false;
+}
+
+const RollingHistogram* GpuProfiler::GetPassHistogram(const std::string& name) const
+{
+    auto it = m_PassHistograms.find(name);
+    return it != m_PassHistograms.end() ? &it->second : nullptr;
+}
+
+void GpuProfiler::PrintReport(std::ostream& out) const
+{
+    if (!m_Enabled)
+    {
+        return;
+    }
+    for (const auto& [name, histogram] : m_PassHistograms)
+    {
+        out << "GPU " << name << ":\n";
+        histogram.Print(out, "ms");
+    }
+}
+
+uint32_t GpuProfiler::AllocatePass(const char* name)
+{
+    if (!m_Recording)
+    {
+        return MaxPassesPerFrame;
+    }
+    Slot& slot = *m_Slots[m_CurrentSlot];
+    if (slot.passCount == MaxPassesPerFrame)
+    {
+        return MaxPassesPerFrame;
+    }
+    slot.passNames[slot.passCount] = name;
+    return slot.passCount++;
+}
+
+void GpuProfiler::Collect(Slot& slot)
+{
+    const size_t size = slot.passCount * 2 * sizeof(uint64_t);
+    const uint64_t* timestamps = static_cast<const uint64_t*>(slot.readback.getConstMappedRange(0, size));
+
+    double frameMs = 0.0;
+    for (uint32_t pass = 0; pass < slot.passCount; ++pass)
+    {
+        const uint64_t begin = timestamps[pass * 2];
+        const uint64_t end = timestamps[pass * 2 + 1];
+        if (end < begin)
+        {
+            // Some drivers reset the counter, such a sample is meaningless
+            continue;
+        }
+        const double ms = static_cast<double>(end - begin) * 1e-6;
+        m_PassHistograms[slot.passNames[pass]].Add(ms);
+        frameMs += ms;
+    }
+    m_LastFrameMs = frameMs;
+
+    slot.readback.unmap();
+    slot.state = SlotState::Free;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+#include "rolling-histogram.h"
+
+// Times render and compute passes on the GPU with timestamp queries. Every pass writes a
+// timestamp at its beginning and end, the frame resolves them into a buffer that is read back
+// asynchronously a few frames later, and the durations feed a rolling histogram per pass.
+// Without the TimestampQuery feature every Begin*Pass returns nullptr and nothing is timed.
+class GpuProfiler
+{
+public:
+    static constexpr uint32_t MaxPassesPerFrame = 8;
+
+    void Init(wgpu::Device device, bool timestampsSupported, uint32_t ringSize);
+    bool IsEnabled() const { return m_Enabled; }
+
+    void BeginFrame();
+    // The returned pointer goes into the pass descriptor and stays valid until EndFrame.
+    const WGPURenderPassTimestampWrites* BeginRenderPass(const char* name);
+    const WGPUComputePassTimestampWrites* BeginComputePass(const char* name);
+    // Resolves the queries of the frame, to be recorded before the encoder is finished.
+    void EndFrame(wgpu::CommandEncoder encoder);
+    // Call after the submit: starts the mapping of the frame and collects older results.
+    // Returns true when the timings of another frame came back.
+    bool Poll();
+    // Waits for the mappings still in flight, their callbacks point at the slots
+    void Release();
+
+    // Latest rolling statistics of one pass, nullptr until it was measured once
+    const RollingHistogram* GetPassHistogram(const std::string& name) const;
+    double GetLastFrameMs() const { return m_LastFrameMs; }
+    void PrintReport(std::ostream& out) const;
+
+private:
+    enum class SlotState
+    {
+        Free,
+        Recording,
+        Resolved,
+        Mapping,
+        Mapped,
+    };
+
+    struct Slot
+    {
+        wgpu::Buffer readback{nullptr};
+        std::array<std::string, MaxPassesPerFrame> passNames;
+        uint32_t passCount{};
+        std::atomic<SlotState> state{SlotState::Free};
+    };
+
+    uint32_t AllocatePass(const char* name);
+    void Collect(Slot& slot);
+
+    static constexpr uint64_t ResolveStride = 256;
+
+    bool m_Enabled{false};
+    wgpu::Device m_Device{nullptr};
+    wgpu::QuerySet m_QuerySet{nullptr};
+    wgpu::Buffer m_ResolveBuffer{nullptr};
+    std::vector<std::unique_ptr<Slot>> m_Slots;
+    uint32_t m_CurrentSlot{};
+    uint64_t m_FrameNumber{};
+    bool m_Recording{false};
+
+    std::array<WGPURenderPassTimestampWrites, MaxPassesPerFrame> m_RenderWrites{};
+    std::array<WGPUComputePassTimestampWrites, MaxPassesPerFrame> m_ComputeWrites{};
+
+    std::map<std::string, RollingHistogram> m_PassHistograms;
+    double m_LastFrameMs{};
+};
@@ -0,0 +1,251 @@
+#include "gpu-tracker.h"
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+using namespace wgpu;
+
+namespace GpuTracker
+{
+    namespace
+    {
+        struct Entry
+        {
+            Category category;
+            std::string label;
+            uint64_t bytes;
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::unordered_map<const void*, Entry> entries;
+            std::array<uint64_t, static_cast<size_t>(Category::Count)> liveBytes{};
+            std::array<size_t, static_cast<size_t>(Category::Count)> liveCounts{};
+            uint64_t totalBytes{};
+            uint64_t peakBytes{};
+        };
+
+        Registry& GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        void Track(const void* handle, Category category, const char* label, uint64_t bytes)
+        {
+            if (!handle)
+            {
+                return;
+            }
+            Registry& registry = GetRegistry();
+            std::lock_guard lock(registry.mutex);
+            registry.entries[handle] = Entry{ category, label ? label : "(unlabeled)", bytes };
+            registry.liveBytes[static_cast<size_t>(category)] += bytes;
+            ++registry.liveCounts[static_cast<size_t>(category)];
+            registry.totalBytes += bytes;
+            registry.peakBytes = std::max(registry.peakBytes, registry.totalBytes);
+        }
+
+        bool Untrack(const void* handle)
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard lock(registry.mutex);
+            auto it = registry.entries.find(handle);
+            if (it == registry.entries.end())
+            {
+                return false;
+            }
+            registry.liveBytes[static_cast<size_t>(it->second.category)] -= it->second.bytes;
+            --registry.liveCounts[static_cast<size_t>(it->second.category)];
+            registry.totalBytes -= it->second.bytes;
+            registry.entries.erase(it);
+            return true;
+        }
+
+        uint32_t GetBytesPerTexel(TextureFormat format)
+        {
+            switch (format)
+            {
+            case TextureFormat::R8Unorm:
+                return 1;
+            case TextureFormat::R16Float:
+            case TextureFormat::RG8Unorm:
+                return 2;
+            case TextureFormat::RGBA16Float:
+            case TextureFormat::RG32Float:
+            case TextureFormat::Depth32FloatStencil8:
+                return 8;
+            case TextureFormat::RGBA32Float:
+                return 16;
+            default:
+                // The 8 bit color formats and Depth24Plus, which drivers store in 32 bits
+                return 4;
+            }
+        }
+
+        template<typename Handle>
+        void ReleaseTracked(Handle& handle, bool destroy)
+        {
+            if (!handle)
+            {
+                return;
+            }
+            // Objects the app did not create, like the swapchain texture, only lose a reference
+            const bool owned = Untrack(handle);
+            if constexpr (requires { handle.destroy(); })
+            {
+                if (destroy && owned) handle.destroy();
+            }
+            handle.release();
+            handle = nullptr;
+        }
+    }
+
+    const char* GetCategoryName(Category category)
+    {
+        switch (category)
+        {
+        case Category::Geometry: return "Geometry";
+        case Category::Uniform: return "Uniform";
+        case Category::Storage: return "Storage";
+        case Category::Indirect: return "Indirect";
+        case Category::Readback: return "Readback";
+        case Category::Staging: return "Staging";
+        case Category::Query: return "Query";
+        case Category::RenderTarget: return "RenderTarget";
+        case Category::Pipeline: return "Pipeline";
+        case Category::BindGroup: return "BindGroup";
+        default: return "Unknown";
+        }
+    }
+
+    uint64_t EstimateTextureBytes(const TextureDescriptor& descriptor)
+    {
+        const uint64_t texelBytes = GetBytesPerTexel(descriptor.format);
+        uint64_t bytes = 0;
+        for (uint32_t level = 0; level < std::max(descriptor.mipLevelCount, 1u); ++level)
+        {
+            const uint64_t width = std::max(descriptor.size.width >> level, 1u);
+            const uint64_t height = std::max(descriptor.size.height >> level, 1u);
+            bytes += width * height * texelBytes;
+        }
+        return bytes * std::max(descriptor.size.depthOrArrayLayers, 1u) * std::max(descriptor.sampleCount, 1u);
+    }
+
+    Buffer CreateBuffer(Device device, const BufferDescriptor& descriptor, Category category)
+    {
+        Buffer buffer = device.createBuffer(descriptor);
+        Track(buffer, category, descriptor.label, descriptor.size);
+        return buffer;
+    }
+
+    Texture CreateTexture(Device device, const TextureDescriptor& descriptor, Category category)
+    {
+        Texture texture = device.createTexture(descriptor);
+        Track(texture, category, descriptor.label, EstimateTextureBytes(descriptor));
+        return texture;
+    }
+
+    QuerySet CreateQuerySet(Device device, const QuerySetDescriptor& descriptor)
+    {
+        QuerySet querySet = device.createQuerySet(descriptor);
+        Track(querySet, Category::Query, descriptor.label, static_cast<uint64_t>(descriptor.count) * sizeof(uint64_t));
+        return querySet;
+    }
+
+    RenderPipeline CreateRenderPipeline(Device device, const RenderPipelineDescriptor& descriptor)
+    {
+        RenderPipeline pipeline = device.createRenderPipeline(descriptor);
+        Track(pipeline, Category::Pipeline, descriptor.label, 0);
+        return pipeline;
+    }
+
+    ComputePipeline CreateComputePipeline(Device device, const ComputePipelineDescriptor& descriptor)
+    {
+        ComputePipeline pipeline = device.createComputePipeline(descriptor);
+        Track(pipeline, Category::Pipeline, descriptor.label, 0);
+        return pipeline;
+    }
+
+    BindGroup CreateBindGroup(Device device, const BindGroupDescriptor& descriptor)
+    {
+        BindGroup bindGroup = device.createBindGroup(descriptor);
+        Track(bindGroup, Category::BindGroup, descriptor.label, 0);
+        return bindGroup;
+    }
+
+    void Release(Buffer& buffer) { ReleaseTracked(buffer, true); }
+    void Release(Texture& texture) { ReleaseTracked(texture, true); }
+    void Release(QuerySet& querySet) { ReleaseTracked(querySet, true); }
+    void Release(RenderPipeline& pipeline) { ReleaseTracked(pipeline, false); }
+    void Release(ComputePipeline& pipeline) { ReleaseTracked(pipeline, false); }
+    void Release(BindGroup& bindGroup) { ReleaseTracked(bindGroup, false); }
+
+    uint64_t GetLiveBytes()
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        return registry.totalBytes;
+    }
+
+    uint64_t GetLiveBytes(Category category)
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        return registry.liveBytes[static_cast<size_t>(category)];
+    }
+
+    uint64_t GetPeakBytes()
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        return registry.peakBytes;
+    }
+
+    size_t GetLiveCount()
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        return registry.entries.size();
+    }
+
+    void PrintReport(std::ostream& out)
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        out << std::fixed << std::setprecision(2)
+            << "GPU memory: " << registry.totalBytes / 1048576.0 << " MB live, "
+            << registry.peakBytes / 1048576.0 << " MB peak, " << registry.entries.size() << " objects\n";
+        for (size_t category = 0; category < static_cast<size_t>(Category::Count); ++category)
+        {
+            if (registry.liveCounts[category] == 0)
+            {
+                continue;
+            }
+            out << "  " << std::left << std::setw(14) << GetCategoryName(static_cast<Category>(category)) << std::right
+                << std::setw(6) << registry.liveCounts[category] << " objects "
+                << std::setw(10) << registry.liveBytes[category] / 1024.0 << " KB\n";
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    size_t ReportLeaks(std::ostream& out)
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        for (const auto& [handle, entry] : registry.entries)
+        {
+            out << "Leaked " << GetCategoryName(entry.category) << " object \"" << entry.label << "\" ("
+                << entry.bytes << " bytes) at " << handle << "\n";
+        }
+        return registry.entries.size();
+    }
+}
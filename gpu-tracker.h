@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <webgpu/webgpu.hpp>
+
+// Accounting of the GPU objects the app creates. Buffers, textures, query sets, pipelines and
+// bind groups made through the Create* functions are recorded with their label, category and size
+// until the matching Release, so live GPU memory can be reported per category and whatever is
+// still alive at shutdown can be listed as a leak. Texture sizes are estimates, the driver may pad.
+namespace GpuTracker
+{
+    enum class Category
+    {
+        Geometry,
+        Uniform,
+        Storage,
+        Indirect,
+        Readback,
+        Staging,
+        Query,
+        RenderTarget,
+        Pipeline,
+        BindGroup,
+        Count,
+    };
+
+    const char* GetCategoryName(Category category);
+    // Bytes of every mip level, layer and sample, as the report counts them
+    uint64_t EstimateTextureBytes(const wgpu::TextureDescriptor& descriptor);
+
+    wgpu::Buffer CreateBuffer(wgpu::Device device, const wgpu::BufferDescriptor& descriptor, Category category);
+    wgpu::Texture CreateTexture(wgpu::Device device, const wgpu::TextureDescriptor& descriptor, Category category);
+    wgpu::QuerySet CreateQuerySet(wgpu::Device device, const wgpu::QuerySetDescriptor& descriptor);
+    wgpu::RenderPipeline CreateRenderPipeline(wgpu::Device device, const wgpu::RenderPipelineDescriptor& descriptor);
+    wgpu::ComputePipeline CreateComputePipeline(wgpu::Device device, const wgpu::ComputePipelineDescriptor& descriptor);
+    wgpu::BindGroup CreateBindGroup(wgpu::Device device, const wgpu::BindGroupDescriptor& descriptor);
+
+    // Destroy where the object has GPU memory, release, forget and reset the handle. Objects that were
+    // not created through the tracker are only released. Null handles are ignored.
+    void Release(wgpu::Buffer& buffer);
+    void Release(wgpu::Texture& texture);
+    void Release(wgpu::QuerySet& querySet);
+    void Release(wgpu::RenderPipeline& pipeline);
+    void Release(wgpu::ComputePipeline& pipeline);
+    void Release(wgpu::BindGroup& bindGroup);
+
+    uint64_t GetLiveBytes();
+    uint64_t GetLiveBytes(Category category);
+    uint64_t GetPeakBytes();
+    size_t GetLiveCount();
+
+    // Live objects and bytes per category
+    void PrintReport(std::ostream& out);
+    // Lists every object that is still alive, returns how many there are
+    size_t ReportLeaks(std::ostream& out);
+}
@@ -0,0 +1,117 @@
+#include "mesh-pool.h"
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+
+using namespace wgpu;
+
+void MeshPool::Init(Device device, uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+    // Buffer copies want 4 byte multiples, two 16 bit indices at a time
+    indexCapacity = (indexCapacity + 1) & ~1u;
+    m_Vertices.Reset(vertexCapacity);
+    m_Indices.Reset(indexCapacity);
+
+    m_VertexBuffer = GpuHandle{GpuTracker::CreateBuffer(device, BufferDescriptor
+    {{
+        .label = "Mesh Pool Vertices",
+        .usage = BufferUsage::CopyDst | BufferUsage::Vertex,
+        .size = static_cast<uint64_t>(vertexCapacity) * VertexStride,
+        .mappedAtCreation = false,
+    }}, GpuTracker::Category::Geometry)};
+    m_IndexBuffer = GpuHandle{GpuTracker::CreateBuffer(device, BufferDescriptor
+    {{
+        .label = "Mesh Pool Indices",
+        .usage = BufferUsage::CopyDst | BufferUsage::Index,
+        .size = static_cast<uint64_t>(indexCapacity) * sizeof(uint16_t),
+        .mappedAtCreation = false,
+    }}, GpuTracker::Category::Geometry)};
+}
+
+MeshPool::AddResult MeshPool::Add(StagingBelt& belt, CommandEncoder encoder, const std::vector<float>& pointData, const std::vector<uint16_t>& indexData, Mesh& mesh)
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(pointData.size() / FloatsPerVertex);
+    const uint32_t indexCount = static_cast<uint32_t>(indexData.size());
+    if (vertexCount == 0 || indexCount == 0)
+    {
+        return AddResult::Empty;
+    }
+
+    auto vertices = m_Vertices.Allocate(vertexCount);
+    if (!vertices)
+    {
+        return AddResult::PoolFull;
+    }
+    auto indices = m_Indices.Allocate((indexCount + 1) & ~1u, 2);
+    if (!indices)
+    {
+        m_Vertices.Free(*vertices);
+        return AddResult::PoolFull;
+    }
+
+    // One staging slice for both before any copy: a copy recorded for a mesh that then fails would land
+    // in ranges the next mesh may get, and a half reserved mesh would hold belt space until Finish.
+    // The vertex stride is a multiple of 4 and odd index counts are padded, so both halves stay aligned.
+    const uint64_t vertexBytes = static_cast<uint64_t>(vertexCount) * VertexStride;
+    const uint64_t indexBytes = static_cast<uint64_t>(indices->size) * sizeof(uint16_t);
+    const auto slice = belt.Allocate(vertexBytes + indexBytes);
+    if (!slice)
+    {
+        Remove(Mesh{ *vertices, *indices, indexCount });
+        return AddResult::NoStagingSpace;
+    }
+    const StagingBelt::Slice vertexSlice{ slice->buffer, slice->offset, vertexBytes, slice->data };
+    const StagingBelt::Slice indexSlice{ slice->buffer, slice->offset + vertexBytes, indexBytes, static_cast<uint8_t*>(slice->data) + vertexBytes };
+    std::memcpy(vertexSlice.data, pointData.data(), vertexBytes);
+    std::memcpy(indexSlice.data, indexData.data(), indexCount * sizeof(uint16_t));
+    if (indices->size > indexCount)
+    {
+        static_cast<uint16_t*>(indexSlice.data)[indexCount] = 0;
+    }
+    belt.Copy(encoder, vertexSlice, m_VertexBuffer, static_cast<uint64_t>(vertices->offset) * VertexStride);
+    belt.Copy(encoder, indexSlice, m_IndexBuffer, static_cast<uint64_t>(indices->offset) * sizeof(uint16_t));
+    mesh = Mesh{ *vertices, *indices, indexCount };
+    return AddResult::Added;
+}
+
+void MeshPool::Remove(const Mesh& mesh)
+{
+    m_Vertices.Free(mesh.vertices);
+    m_Indices.Free(mesh.indices);
+}
+
+void MeshPool::Release()
+{
+    m_VertexBuffer.Reset();
+    m_IndexBuffer.Reset();
+    m_Vertices.Reset(0);
+    m_Indices.Reset(0);
+}
+
+void MeshPool::Bind(RenderPassEncoder renderPass) const
+{
+    renderPass.setVertexBuffer(0, m_VertexBuffer, 0, GetVertexBufferSize());
+    renderPass.setIndexBuffer(m_IndexBuffer, IndexFormat::Uint16, 0, GetIndexBufferSize());
+}
+
+void MeshPool::Draw(RenderPassEncoder renderPass, const Mesh& mesh, uint32_t instanceCount, uint32_t firstInstance) const
+{
+    renderPass.drawIndexed(mesh.indexCount, instanceCount, mesh.GetFirstIndex(), mesh.GetBaseVertex(), firstInstance);
+}
+
+void MeshPool::PrintReport(std::ostream& out) const
+{
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(1) << "Mesh pool: " << GetMeshCount() << " meshes\n";
+    for (const auto& [name, allocator] : { std::pair{ "vertices", &m_Vertices }, std::pair{ "indices", &m_Indices } })
+    {
+        const double capacity = std::max<double>(allocator->GetCapacity(), 1.0);
+        out << "  " << std::left << std::setw(9) << name << std::right
+            << std::setw(6) << 100.0 * allocator->GetUsed() / capacity << "% used of " << allocator->GetCapacity()
+            << ", " << allocator->GetFreeRangeCount() << " free ranges, largest " << allocator->GetLargestFreeRange()
+            << ", fragmentation " << 100.0 * allocator->GetFragmentation() << "%\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
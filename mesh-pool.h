@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+#include "gpu-handle.h"
+#include "offset-allocator.h"
+#include "staging-belt.h"
+
+// All meshes share one vertex buffer and one index buffer. A mesh is a range in each, drawn with
+// firstIndex/baseVertex, so the pool is bound once per pass however many meshes it holds and the
+// driver sees two allocations instead of two per mesh. Vertices are x, y, r, g, b floats and the
+// indices are 16 bit and relative to the mesh, a single mesh stays below 65536 vertices.
+class MeshPool
+{
+public:
+    static constexpr uint32_t FloatsPerVertex = 5;
+    static constexpr uint32_t VertexStride = FloatsPerVertex * sizeof(float);
+
+    struct Mesh
+    {
+        OffsetAllocator::Allocation vertices;
+        OffsetAllocator::Allocation indices;
+        uint32_t indexCount{};
+
+        uint32_t GetFirstIndex() const { return indices.offset; }
+        int32_t GetBaseVertex() const { return static_cast<int32_t>(vertices.offset); }
+    };
+
+    enum class AddResult
+    {
+        Added,
+        // Nothing to upload
+        Empty,
+        // No free ranges large enough, final for this mesh until others are removed
+        PoolFull,
+        // The belt had no staging space this frame, worth another try next frame
+        NoStagingSpace,
+    };
+
+    void Init(wgpu::Device device, uint32_t vertexCapacity, uint32_t indexCapacity);
+    // Records the upload of the mesh into free ranges of the pool and fills in mesh when it was added
+    AddResult Add(StagingBelt& belt, wgpu::CommandEncoder encoder, const std::vector<float>& pointData, const std::vector<uint16_t>& indexData, Mesh& mesh);
+    // The ranges are reused right away. A mesh dropped at runtime goes through
+    // FrameContextManager::OnRetire so no frame in flight still draws it when the ranges are reused.
+    void Remove(const Mesh& mesh);
+    void Release();
+
+    void Bind(wgpu::RenderPassEncoder renderPass) const;
+    void Draw(wgpu::RenderPassEncoder renderPass, const Mesh& mesh, uint32_t instanceCount = 1, uint32_t firstInstance = 0) const;
+
+    wgpu::Buffer GetVertexBuffer() const { return m_VertexBuffer; }
+    wgpu::Buffer GetIndexBuffer() const { return m_IndexBuffer; }
+    uint64_t GetVertexBufferSize() const { return static_cast<uint64_t>(m_Vertices.GetCapacity()) * VertexStride; }
+    uint64_t GetIndexBufferSize() const { return static_cast<uint64_t>(m_Indices.GetCapacity()) * sizeof(uint16_t); }
+    size_t GetMeshCount() const { return m_Vertices.GetAllocationCount(); }
+
+    // Occupancy and fragmentation of both buffers
+    void PrintReport(std::ostream& out) const;
+
+    // Largest of the two buffers, for the maxBufferSize limit
+    static uint64_t GetLargestBufferSize(uint32_t vertexCapacity, uint32_t indexCapacity)
+    {
+        return std::max<uint64_t>(static_cast<uint64_t>(vertexCapacity) * VertexStride, static_cast<uint64_t>(indexCapacity) * sizeof(uint16_t));
+    }
+
+private:
+    GpuHandle<wgpu::Buffer> m_VertexBuffer;
+    GpuHandle<wgpu::Buffer> m_IndexBuffer;
+    OffsetAllocator m_Vertices;
+    OffsetAllocator m_Indices;
+};
@@ -0,0 +1,484 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <GLFW/glfw3.h>
+#include "app.h"
+#include "draw-sorter.h"
+#include "frame-graph.h"
+#include "offset-allocator.h"
+#include "rolling-histogram.h"
+
+// CPU-side hot paths timed in isolation, in the spirit of Google Benchmark: every benchmark runs
+// its body in growing batches until a batch takes long enough to time, then reports the time per
+// iteration. The JSON output of one commit is the baseline of the next.
+
+namespace
+{
+    class State
+    {
+    public:
+        explicit State(uint64_t iterations) : m_Remaining(iterations) {}
+        bool KeepRunning() { return m_Remaining-- > 0; }
+        // Bytes or items handled per iteration, reported as a rate
+        void SetBytesPerIteration(uint64_t bytes) { m_BytesPerIteration = bytes; }
+        uint64_t GetBytesPerIteration() const { return m_BytesPerIteration; }
+        // For benchmarks that cannot run here, call it instead of the loop
+        void Skip(const char* reason) { m_SkipReason = reason; }
+        const char* GetSkipReason() const { return m_SkipReason; }
+        // For benchmarks that check their result: the run fails and MicroBench exits with 1
+        void Fail(const char* reason) { m_FailReason = reason; }
+        const char* GetFailReason() const { return m_FailReason; }
+
+    private:
+        uint64_t m_Remaining;
+        uint64_t m_BytesPerIteration{};
+        const char* m_SkipReason{nullptr};
+        const char* m_FailReason{nullptr};
+    };
+
+    struct Benchmark
+    {
+        std::string name;
+        std::function<void(State&)> body;
+    };
+
+    std::vector<Benchmark>& Registry()
+    {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    struct Registration
+    {
+        Registration(const char* name, void (*body)(State&)) { Registry().push_back({ name, body }); }
+    };
+
+#define MICROBENCH(name) \
+    void name(State& state); \
+    const Registration name##Registration{#name, name}; \
+    void name(State& state)
+
+    // Keeps the compiler from dropping a computation whose result is otherwise unused
+    template<typename T>
+    void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    struct Result
+    {
+        std::string name;
+        uint64_t iterations{};
+        double nsPerIteration{};
+        double bytesPerSecond{};
+        const char* skipReason{nullptr};
+        const char* failReason{nullptr};
+    };
+
+    Result Run(const Benchmark& benchmark, double minSeconds)
+    {
+        using Clock = std::chrono::steady_clock;
+        uint64_t iterations = 1;
+        while (true)
+        {
+            State state(iterations);
+            const auto start = Clock::now();
+            benchmark.body(state);
+            const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (state.GetSkipReason() || state.GetFailReason())
+            {
+                Result result{ benchmark.name };
+                result.skipReason = state.GetSkipReason();
+                result.failReason = state.GetFailReason();
+                return result;
+            }
+            if (seconds >= minSeconds || iterations >= (1ull << 40))
+            {
+                Result result{ benchmark.name, iterations, seconds * 1e9 / static_cast<double>(iterations) };
+                result.bytesPerSecond = static_cast<double>(state.GetBytesPerIteration()) * iterations / seconds;
+                return result;
+            }
+            // Aim a little past the minimum so the next batch is most likely the last
+            const double scale = seconds > 0.0 ? std::min(minSeconds * 1.4 / seconds, 10.0) : 10.0;
+            iterations = std::max(iterations + 1, static_cast<uint64_t>(static_cast<double>(iterations) * scale));
+        }
+    }
+
+    // Reads the results back from an earlier JSON output, one benchmark per line
+    std::map<std::string, double> LoadBaseline(const std::string& path)
+    {
+        std::map<std::string, double> baseline;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            const size_t name = line.find("\"name\": \"");
+            const size_t time = line.find("\"ns_per_iteration\": ");
+            if (name == std::string::npos || time == std::string::npos)
+            {
+                continue;
+            }
+            const size_t nameStart = name + 9;
+            const size_t nameEnd = line.find('"', nameStart);
+            const char* timeStart = line.c_str() + time + 20;
+            char* timeEnd = nullptr;
+            const double nsPerIteration = std::strtod(timeStart, &timeEnd);
+            // A hand-edited or truncated baseline loses the line, not the whole run
+            if (nameEnd == std::string::npos || timeEnd == timeStart)
+            {
+                continue;
+            }
+            baseline[line.substr(nameStart, nameEnd - nameStart)] = nsPerIteration;
+        }
+        return baseline;
+    }
+
+    // Same layout as MyUniforms in app.cpp, keep the two in sync
+    struct DrawUniforms
+    {
+        std::array<float, 4> color;
+        float time;
+        float aspectRatio;
+        float depth;
+        float _pad[1];
+    };
+    static_assert(sizeof(DrawUniforms) == 32);
+
+    std::string GamepadMappings(uint32_t count)
+    {
+        std::ostringstream mappings;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            mappings << "03000000" << std::hex << std::setw(8) << std::setfill('0') << i << std::dec
+                     << "0000000000000000,Bench Pad " << i
+                     << ",a:b0,b:b1,x:b2,y:b3,back:b6,guide:b8,start:b7,leftstick:b9,rightstick:b10,"
+                        "leftshoulder:b4,rightshoulder:b5,dpup:h0.1,dpdown:h0.4,dpleft:h0.8,dpright:h0.2,"
+                        "leftx:a0,lefty:a1,rightx:a3,righty:a4,lefttrigger:a2,righttrigger:a5,platform:Linux,\n";
+        }
+        return mappings.str();
+    }
+}
+
+MICROBENCH(LoadGeometryLogo)
+{
+    std::vector<float> points;
+    std::vector<uint16_t> indices;
+    while (state.KeepRunning())
+    {
+        LoadGeometry(RESOURCE_DIR "/webgpu.txt", points, indices);
+        DoNotOptimize(points.data());
+    }
+}
+
+MICROBENCH(LoadGeometryPyramid)
+{
+    std::vector<float> points;
+    std::vector<uint16_t> indices;
+    while (state.KeepRunning())
+    {
+        LoadGeometry(RESOURCE_DIR "/pyramid.txt", points, indices);
+        DoNotOptimize(points.data());
+    }
+}
+
+MICROBENCH(GenerateGrid128)
+{
+    std::vector<float> points;
+    std::vector<uint16_t> indices;
+    state.SetBytesPerIteration(129 * 129 * 5 * sizeof(float) + 128 * 128 * 6 * sizeof(uint16_t));
+    while (state.KeepRunning())
+    {
+        GenerateGridGeometry(128, points, indices);
+        DoNotOptimize(indices.data());
+    }
+}
+
+MICROBENCH(CeilToNextMultiple)
+{
+    uint32_t value = 1;
+    while (state.KeepRunning())
+    {
+        value = ceilToNextMultiple(value + 17, 256) & 0xffff;
+        DoNotOptimize(value);
+    }
+}
+
+MICROBENCH(PackUniforms1024)
+{
+    // What Render() writes for the uniform-churn scene: time and depth of 1024 draws at their aligned slices
+    constexpr uint32_t drawCount = 1024;
+    const uint32_t stride = ceilToNextMultiple(sizeof(DrawUniforms), 256);
+    std::vector<uint8_t> staging(drawCount * stride);
+    DrawUniforms uniforms{ { 0.0f, 1.0f, 0.4f, 1.0f }, 0.0f, 16.0f / 9.0f, 0.0f, {} };
+    state.SetBytesPerIteration(drawCount * sizeof(DrawUniforms));
+    float time = 0.0f;
+    while (state.KeepRunning())
+    {
+        time += 1.0f / 60.0f;
+        for (uint32_t draw = 0; draw < drawCount; ++draw)
+        {
+            uniforms.time = (draw % 2 == 0 ? time : -time) + 0.37f * static_cast<float>(draw / 2);
+            uniforms.depth = 1.0f - static_cast<float>(draw + 1) / static_cast<float>(drawCount + 1);
+            std::memcpy(staging.data() + draw * stride, &uniforms, sizeof(DrawUniforms));
+        }
+        DoNotOptimize(staging.data());
+    }
+}
+
+MICROBENCH(SortDraws1024)
+{
+    // What Render() sorts for the uniform-churn scene, half of the draws translucent
+    constexpr uint32_t drawCount = 1024;
+    DrawSorter sorter;
+    state.SetBytesPerIteration(drawCount * sizeof(uint64_t));
+    uint32_t seed = 1;
+    while (state.KeepRunning())
+    {
+        sorter.Clear();
+        for (uint32_t draw = 0; draw < drawCount; ++draw)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            sorter.Add(draw, static_cast<float>(seed >> 8) / 16777216.0f, draw % 2 == 1);
+        }
+        sorter.Sort();
+        DoNotOptimize(sorter.GetOrder().data());
+    }
+}
+
+MICROBENCH(CompileFrameGraph)
+{
+    // A debug pass nobody reads and two transients whose lifetimes do not overlap: the graph has to
+    // cull the pass and put both transients in one texture. Without a pool it only plans.
+    const FrameGraph::TextureDesc desc{ "Transient", 1280, 720, wgpu::TextureFormat::RGBA8Unorm };
+    FrameGraph graph;
+    const auto build = [&graph, &desc]() {
+        graph.Reset();
+        const FrameGraph::ResourceId target = graph.ImportTexture("Target", nullptr, nullptr);
+        FrameGraph::ResourceId first = FrameGraph::InvalidResource;
+        FrameGraph::ResourceId second = FrameGraph::InvalidResource;
+        const auto noop = [](const FrameGraph&, wgpu::CommandEncoder) {};
+        graph.AddPass("First", [&](FrameGraph::PassBuilder& builder) { first = builder.Create(desc); }, noop);
+        graph.AddPass("Debug", [&](FrameGraph::PassBuilder& builder) { builder.Read(first); builder.Create(desc); }, noop);
+        graph.AddPass("Resolve First", [&](FrameGraph::PassBuilder& builder) { builder.Read(first); builder.Write(target); }, noop);
+        graph.AddPass("Second", [&](FrameGraph::PassBuilder& builder) { second = builder.Create(desc); }, noop);
+        graph.AddPass("Resolve Second", [&](FrameGraph::PassBuilder& builder) { builder.Read(second); builder.Write(target); }, noop);
+    };
+
+    // Every iteration builds the same graph, so the plan is checked once outside the timed loop
+    build();
+    if (!graph.Compile())
+    {
+        state.Fail("the graph did not compile");
+        return;
+    }
+    const FrameGraph::Stats& stats = graph.GetStats();
+    if (stats.culledPassCount != 1)
+    {
+        state.Fail("the unread debug pass was not culled");
+        return;
+    }
+    if (stats.transientTextureCount != 2 || stats.physicalTextureCount != 1)
+    {
+        state.Fail("the two transients do not share one texture");
+        return;
+    }
+
+    while (state.KeepRunning())
+    {
+        build();
+        DoNotOptimize(graph.Compile());
+        DoNotOptimize(graph.GetStats().physicalBytes);
+    }
+}
+
+MICROBENCH(SubAllocateChurn)
+{
+    // Meshes of mixed sizes streaming in and out of a 64k vertex pool, a steady state of ~200 live
+    OffsetAllocator allocator(1u << 16);
+    std::vector<OffsetAllocator::Allocation> live;
+    uint32_t seed = 1;
+    while (state.KeepRunning())
+    {
+        seed = seed * 1664525u + 1013904223u;
+        if (live.size() < 200 || (seed >> 16) % 2 == 0)
+        {
+            if (auto allocation = allocator.Allocate(16 + (seed >> 20) % 512, 2))
+            {
+                live.push_back(*allocation);
+            }
+        }
+        else
+        {
+            const size_t victim = (seed >> 8) % live.size();
+            allocator.Free(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+    }
+    DoNotOptimize(allocator.GetFragmentation());
+}
+
+MICROBENCH(HistogramPercentile240)
+{
+    // FormatSummary asks for three percentiles of the frame-time window every title update
+    RollingHistogram histogram(240);
+    for (uint32_t i = 0; i < 240; ++i)
+    {
+        histogram.Add(16.0 + static_cast<double>((i * 7919) % 100) * 0.01);
+    }
+    while (state.KeepRunning())
+    {
+        DoNotOptimize(histogram.GetPercentile(0.99));
+    }
+}
+
+MICROBENCH(GamepadMappings256)
+{
+    if (!glfwInit())
+    {
+        state.Skip("GLFW could not initialize, no display?");
+        return;
+    }
+    const std::string mappings = GamepadMappings(256);
+    state.SetBytesPerIteration(mappings.size());
+    while (state.KeepRunning())
+    {
+        DoNotOptimize(glfwUpdateGamepadMappings(mappings.c_str()));
+    }
+    glfwTerminate();
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    std::string outputPath;
+    std::string baselinePath;
+    double minSeconds = 0.25;
+    double threshold = 0.10;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue)
+        {
+            filter = argv[++i];
+        }
+        else if (arg == "--output" && hasValue)
+        {
+            outputPath = argv[++i];
+        }
+        else if (arg == "--baseline" && hasValue)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (arg == "--min-time" && hasValue)
+        {
+            minSeconds = std::max(std::atof(argv[++i]), 0.001);
+        }
+        else if (arg == "--threshold" && hasValue)
+        {
+            threshold = std::atof(argv[++i]) / 100.0;
+        }
+        else
+        {
+            std::cout << "Usage: " << argv[0] << " [options]\n"
+                      << "  --filter <text>         Only run benchmarks whose name contains <text>\n"
+                      << "  --min-time <s>          Time every benchmark for at least s seconds (default 0.25)\n"
+                      << "  --output <file>         Write the results as JSON\n"
+                      << "  --baseline <file>       Compare with an earlier JSON output, fail on regressions\n"
+                      << "  --threshold <percent>   Slowdown that counts as a regression (default 10)\n";
+            return 1;
+        }
+    }
+
+    const std::map<std::string, double> baseline = baselinePath.empty() ? std::map<std::string, double>{} : LoadBaseline(baselinePath);
+    std::vector<Result> results;
+    uint32_t regressions = 0;
+    uint32_t failures = 0;
+    std::cout << std::left << std::setw(28) << "Benchmark" << std::right << std::setw(14) << "ns/iter"
+              << std::setw(14) << "iterations" << std::setw(12) << "MB/s" << std::setw(12) << "change" << "\n";
+    for (const Benchmark& benchmark : Registry())
+    {
+        if (benchmark.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        const Result result = Run(benchmark, minSeconds);
+        if (result.failReason)
+        {
+            std::cout << std::left << std::setw(28) << result.name << "FAILED: " << result.failReason << std::endl;
+            ++failures;
+            continue;
+        }
+        if (result.skipReason)
+        {
+            std::cout << std::left << std::setw(28) << result.name << "skipped: " << result.skipReason << std::endl;
+            continue;
+        }
+        std::cout << std::left << std::setw(28) << result.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << result.nsPerIteration << std::setw(14) << result.iterations
+                  << std::setw(12) << result.bytesPerSecond / 1e6;
+        auto previous = baseline.find(result.name);
+        if (previous != baseline.end() && previous->second > 0.0)
+        {
+            const double change = result.nsPerIteration / previous->second - 1.0;
+            std::cout << std::setw(11) << std::showpos << change * 100.0 << "%" << std::noshowpos;
+            if (change > threshold)
+            {
+                std::cout << "  REGRESSION";
+                ++regressions;
+            }
+        }
+        std::cout << std::endl;
+        results.push_back(result);
+    }
+
+    if (!outputPath.empty())
+    {
+        std::ofstream file(outputPath);
+        if (!file)
+        {
+            std::cerr << "Could not write " << outputPath << std::endl;
+            return 1;
+        }
+        file << "{\n  \"benchmarks\": [\n" << std::setprecision(3) << std::fixed;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Result& result = results[i];
+            file << "    { \"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+                 << ", \"ns_per_iteration\": " << result.nsPerIteration
+                 << ", \"bytes_per_second\": " << result.bytesPerSecond << " }"
+                 << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n}" << std::endl;
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " benchmark(s) failed their checks" << std::endl;
+        return 1;
+    }
+    if (regressions > 0)
+    {
+        std::cerr << regressions << " benchmark(s) slower than the baseline by more than "
+                  << threshold * 100.0 << "%" << std::endl;
+        return 1;
+    }
+    return 0;
+}
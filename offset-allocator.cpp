@@ -0,0 +1,121 @@
+#include "offset-allocator.h"
+#include <cassert>
+
+OffsetAllocator::OffsetAllocator(uint32_t capacity)
+{
+    Reset(capacity);
+}
+
+void OffsetAllocator::Reset(uint32_t capacity)
+{
+    m_Capacity = capacity;
+    m_Used = 0;
+    m_AllocationCount = 0;
+    m_FreeByOffset.clear();
+    m_FreeBySize.clear();
+    if (capacity > 0)
+    {
+        InsertFree(0, capacity);
+    }
+}
+
+std::optional<OffsetAllocator::Allocation> OffsetAllocator::Allocate(uint32_t size, uint32_t alignment)
+{
+    if (size == 0 || alignment == 0)
+    {
+        return std::nullopt;
+    }
+
+    // The smallest free range that still fits once its start is aligned. Ranges that are large enough
+    // but lose too much to alignment are skipped, they are rare with the alignments used here.
+    for (auto it = m_FreeBySize.lower_bound(size); it != m_FreeBySize.end(); ++it)
+    {
+        const uint32_t rangeOffset = it->second;
+        const uint32_t rangeSize = it->first;
+        const uint32_t aligned = (rangeOffset + alignment - 1) / alignment * alignment;
+        const uint32_t padding = aligned - rangeOffset;
+        if (static_cast<uint64_t>(padding) + size > rangeSize)
+        {
+            continue;
+        }
+
+        EraseFree(m_FreeByOffset.find(rangeOffset));
+        if (padding > 0)
+        {
+            InsertFree(rangeOffset, padding);
+        }
+        if (rangeSize > padding + size)
+        {
+            InsertFree(aligned + size, rangeSize - padding - size);
+        }
+        m_Used += size;
+        ++m_AllocationCount;
+        return Allocation{ aligned, size };
+    }
+    return std::nullopt;
+}
+
+void OffsetAllocator::Free(const Allocation& allocation)
+{
+    if (allocation.size == 0)
+    {
+        return;
+    }
+    assert(allocation.offset + allocation.size <= m_Capacity);
+
+    uint32_t offset = allocation.offset;
+    uint32_t size = allocation.size;
+    m_Used -= size;
+    --m_AllocationCount;
+
+    // Merge with the free range right after and the one right before
+    auto next = m_FreeByOffset.lower_bound(offset);
+    if (next != m_FreeByOffset.end() && next->first == offset + size)
+    {
+        size += next->second;
+        next = std::next(next);
+        EraseFree(std::prev(next));
+    }
+    if (next != m_FreeByOffset.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            offset = previous->first;
+            size += previous->second;
+            EraseFree(previous);
+        }
+    }
+    InsertFree(offset, size);
+}
+
+uint32_t OffsetAllocator::GetLargestFreeRange() const
+{
+    return m_FreeBySize.empty() ? 0 : m_FreeBySize.rbegin()->first;
+}
+
+double OffsetAllocator::GetFragmentation() const
+{
+    const uint32_t free = GetFree();
+    return free > 0 ? 1.0 - static_cast<double>(GetLargestFreeRange()) / static_cast<double>(free) : 0.0;
+}
+
+void OffsetAllocator::InsertFree(uint32_t offset, uint32_t size)
+{
+    m_FreeByOffset.emplace(offset, size);
+    m_FreeBySize.emplace(size, offset);
+}
+
+void OffsetAllocator::EraseFree(std::map<uint32_t, uint32_t>::iterator byOffset)
+{
+    auto [first, last] = m_FreeBySize.equal_range(byOffset->second);
+    for (auto it = first; it != last; ++it)
+    {
+        if (it->second == byOffset->first)
+        {
+            m_FreeBySize.erase(it);
+            break;
+        }
+    }
+    m_FreeByOffset.erase(byOffset);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+// Hands out aligned ranges of [0, capacity) in arbitrary units (bytes, vertices, indices) for
+// carving one large GPU buffer into many allocations. Best fit over a size-ordered free list, freed
+// ranges merge with their free neighbours. Purely CPU-side bookkeeping, it never touches the GPU.
+class OffsetAllocator
+{
+public:
+    struct Allocation
+    {
+        uint32_t offset{};
+        uint32_t size{};
+    };
+
+    explicit OffsetAllocator(uint32_t capacity = 0);
+    void Reset(uint32_t capacity);
+
+    // std::nullopt when no free range is large enough
+    std::optional<Allocation> Allocate(uint32_t size, uint32_t alignment = 1);
+    void Free(const Allocation& allocation);
+
+    uint32_t GetCapacity() const { return m_Capacity; }
+    uint32_t GetUsed() const { return m_Used; }
+    uint32_t GetFree() const { return m_Capacity - m_Used; }
+    uint32_t GetLargestFreeRange() const;
+    size_t GetAllocationCount() const { return m_AllocationCount; }
+    size_t GetFreeRangeCount() const { return m_FreeByOffset.size(); }
+    // 0 when all free space is one range, close to 1 when it is scattered in small pieces
+    double GetFragmentation() const;
+
+private:
+    void InsertFree(uint32_t offset, uint32_t size);
+    void EraseFree(std::map<uint32_t, uint32_t>::iterator byOffset);
+
+    uint32_t m_Capacity{};
+    uint32_t m_Used{};
+    size_t m_AllocationCount{};
+    // offset -> size, for merging neighbours
+    std::map<uint32_t, uint32_t> m_FreeByOffset;
+    // size -> offset, for best fit
+    std::multimap<uint32_t, uint32_t> m_FreeBySize;
+};
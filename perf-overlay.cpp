@@ -0,0 +1,138 @@
+#include "perf-overlay.h"
+#include "gpu-tracker.h"
+#include <algorithm>
+
+using namespace wgpu;
+
+bool PerfOverlay::Init(Device device, ShaderModule shader, TextureFormat colorFormat, TextureFormat depthFormat, uint32_t sampleCount)
+{
+    if (!shader)
+    {
+        return false;
+    }
+
+    m_UniformBuffer = GpuTracker::CreateBuffer(device, BufferDescriptor
+    {{
+        .label = "Overlay Uniforms",
+        .usage = BufferUsage::CopyDst | BufferUsage::Uniform,
+        .size = sizeof(OverlayUniforms),
+        .mappedAtCreation = false,
+    }}, GpuTracker::Category::Uniform);
+    m_SampleBuffer = GpuTracker::CreateBuffer(device, BufferDescriptor
+    {{
+        .label = "Overlay Frame Times",
+        .usage = BufferUsage::CopyDst | BufferUsage::Storage,
+        .size = SampleCount * sizeof(float),
+        .mappedAtCreation = false,
+    }}, GpuTracker::Category::Storage);
+
+    BlendState blendState
+    {{
+        .color = {BlendComponent{{BlendOperation::Add, BlendFactor::SrcAlpha, BlendFactor::OneMinusSrcAlpha}}},
+        .alpha = {BlendComponent{{BlendOperation::Add, BlendFactor::One, BlendFactor::Zero}}}
+    }};
+    ColorTargetState colorTarget
+    {{
+        .format = colorFormat,
+        .blend = &blendState,
+        .writeMask = ColorWriteMask::All
+    }};
+    FragmentState fragmentState
+    {{
+        .module = shader,
+        .entryPoint = "fs_main",
+        .constantCount = 0,
+        .constants = nullptr,
+        .targetCount = 1,
+        .targets = &colorTarget
+    }};
+
+    // Always on top, whatever the scene left in the depth buffer
+    DepthStencilState depthStencilState = Default;
+    depthStencilState.format = depthFormat;
+    depthStencilState.depthWriteEnabled = false;
+    depthStencilState.depthCompare = CompareFunction::Always;
+    depthStencilState.stencilReadMask = 0;
+    depthStencilState.stencilWriteMask = 0;
+
+    // The quads are generated from the vertex and instance index, there is no vertex buffer
+    m_Pipeline = GpuTracker::CreateRenderPipeline(device, RenderPipelineDescriptor
+    {{
+        .label = "Overlay Pipeline",
+        .layout = nullptr,
+        .vertex = VertexState
+        {{
+            .module = shader,
+            .entryPoint = "vs_main",
+            .constantCount = 0,
+            .constants = nullptr,
+            .bufferCount = 0,
+            .buffers = nullptr,
+        }},
+        .primitive = PrimitiveState
+        {{
+            .topology = PrimitiveTopology::TriangleList,
+            .stripIndexFormat = IndexFormat::Undefined,
+            .frontFace = FrontFace::CCW,
+            .cullMode = CullMode::None
+        }},
+        .depthStencil = depthFormat != TextureFormat::Undefined ? &depthStencilState : nullptr,
+        .multisample = MultisampleState{{.count = sampleCount, .mask = ~0u, .alphaToCoverageEnabled = false}},
+        .fragment = &fragmentState,
+    }});
+
+    std::vector entries{
+        BindGroupEntry{{ .binding = 0, .buffer = m_UniformBuffer, .offset = 0, .size = sizeof(OverlayUniforms) }},
+        BindGroupEntry{{ .binding = 1, .buffer = m_SampleBuffer, .offset = 0, .size = SampleCount * sizeof(float) }},
+    };
+    BindGroupLayout layout = m_Pipeline.getBindGroupLayout(0);
+    m_BindGroup = GpuTracker::CreateBindGroup(device, BindGroupDescriptor
+    {{
+        .label = "Overlay Bind Group",
+        .layout = layout,
+        .entryCount = static_cast<uint32_t>(entries.size()),
+        .entries = entries.data(),
+    }});
+    layout.release();
+
+    m_Samples.assign(SampleCount, 0.0f);
+    return static_cast<bool>(m_Pipeline);
+}
+
+void PerfOverlay::Update(Queue queue, const RollingHistogram& frameTimes)
+{
+    // Oldest frame on the left, the newest one on the right edge
+    std::fill(m_Samples.begin(), m_Samples.end(), 0.0f);
+    const size_t count = std::min<size_t>(frameTimes.GetCount(), SampleCount);
+    for (size_t age = 0; age < count; ++age)
+    {
+        m_Samples[SampleCount - 1 - age] = static_cast<float>(frameTimes.GetRecent(age));
+    }
+    queue.writeBuffer(m_SampleBuffer, 0, m_Samples.data(), m_Samples.size() * sizeof(float));
+
+    // Budget lines at 60 and 30 Hz, the graph grows when a spike is taller than that
+    const float budgetMs = 1000.0f / 60.0f;
+    const float warningMs = 1000.0f / 30.0f;
+    const float topMs = std::max(warningMs * 1.5f, static_cast<float>(frameTimes.GetMax()));
+    const OverlayUniforms uniforms{
+        { -0.98f, 0.6f, 0.6f, 0.36f },
+        { topMs, static_cast<float>(SampleCount), budgetMs, warningMs },
+    };
+    queue.writeBuffer(m_UniformBuffer, 0, &uniforms, sizeof(OverlayUniforms));
+}
+
+void PerfOverlay::Draw(RenderPassEncoder renderPass) const
+{
+    renderPass.setPipeline(m_Pipeline);
+    renderPass.setBindGroup(0, m_BindGroup, 0, nullptr);
+    // Background and the two level lines come before the bars
+    renderPass.draw(6, 3 + SampleCount, 0, 0);
+}
+
+void PerfOverlay::Release()
+{
+    GpuTracker::Release(m_BindGroup);
+    GpuTracker::Release(m_Pipeline);
+    GpuTracker::Release(m_UniformBuffer);
+    GpuTracker::Release(m_SampleBuffer);
+}
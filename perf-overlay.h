@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+#include "rolling-histogram.h"
+
+// Frame-time graph drawn on top of the scene: one bar per recent frame, colored against the frame
+// budget, with the budget and warning levels as lines. The numbers go into the window title.
+class PerfOverlay
+{
+public:
+    static constexpr uint32_t SampleCount = 120;
+
+    // The depth format and sample count are the ones of the pass the overlay is drawn in, Undefined without a depth buffer
+    bool Init(wgpu::Device device, wgpu::ShaderModule shader, wgpu::TextureFormat colorFormat,
+              wgpu::TextureFormat depthFormat = wgpu::TextureFormat::Undefined, uint32_t sampleCount = 1);
+    void Update(wgpu::Queue queue, const RollingHistogram& frameTimes);
+    void Draw(wgpu::RenderPassEncoder renderPass) const;
+    void Release();
+
+private:
+    struct OverlayUniforms
+    {
+        std::array<float, 4> rect;   // left, bottom, width, height in clip space
+        std::array<float, 4> scale;  // ms at the top of the graph, sample count, budget ms, warning ms
+    };
+
+    wgpu::RenderPipeline m_Pipeline{nullptr};
+    wgpu::Buffer m_UniformBuffer{nullptr};
+    wgpu::Buffer m_SampleBuffer{nullptr};
+    wgpu::BindGroup m_BindGroup{nullptr};
+    std::vector<float> m_Samples;
+};
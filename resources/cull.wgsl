@@ -0,0 +1,44 @@
+struct CullUniforms {
+    planes: array<vec4f, 4>,
+    camera: vec4f,
+    objectCount: u32,
+};
+
+struct ObjectData {
+    placement: vec4f, // xy offset, scale, depth
+    color: vec4f,
+    bounds: vec4f,    // world space bounding sphere, xyz center and w radius
+};
+
+struct DrawIndexedArgs {
+    indexCount: u32,
+    instanceCount: atomic<u32>,
+    firstIndex: u32,
+    baseVertex: i32,
+    firstInstance: u32,
+};
+
+@group(0) @binding(0) var<uniform> uCull: CullUniforms;
+@group(0) @binding(1) var<storage, read> objects: array<ObjectData>;
+@group(0) @binding(2) var<storage, read_write> drawArgs: DrawIndexedArgs;
+@group(0) @binding(3) var<storage, read_write> visibleObjects: array<u32>;
+
+@compute @workgroup_size(64)
+fn cs_cull(@builtin(global_invocation_id) id: vec3u) {
+    let index = id.x;
+    if (index >= uCull.objectCount) {
+        return;
+    }
+
+    let sphere = objects[index].bounds;
+    for (var i = 0u; i < 4u; i++) {
+        let plane = uCull.planes[i];
+        if (dot(plane.xyz, sphere.xyz) + plane.w < -sphere.w) {
+            return;
+        }
+    }
+
+    // Compact the survivors, every one of them is an instance of the single indirect draw
+    let slot = atomicAdd(&drawArgs.instanceCount, 1u);
+    visibleObjects[slot] = index;
+}
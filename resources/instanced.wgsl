@@ -0,0 +1,42 @@
+struct CullUniforms {
+    planes: array<vec4f, 4>,
+    camera: vec4f,
+    objectCount: u32,
+};
+
+struct ObjectData {
+    placement: vec4f, // xy offset, scale, depth
+    color: vec4f,
+    bounds: vec4f,
+};
+
+@group(0) @binding(0) var<uniform> uCull: CullUniforms;
+@group(0) @binding(1) var<storage, read> objects: array<ObjectData>;
+@group(0) @binding(2) var<storage, read> visibleObjects: array<u32>;
+
+struct VertexInput {
+	@location(0) position: vec2f,
+	@location(1) color: vec3f,
+};
+
+struct VertexOutput {
+	@builtin(position) position: vec4f,
+	@location(0) color: vec3f,
+};
+
+@vertex
+fn vs_main(in: VertexInput, @builtin(instance_index) instance: u32) -> VertexOutput {
+	let object = objects[visibleObjects[instance]];
+	let world = in.position * object.placement.z + object.placement.xy;
+	let view = (world - uCull.camera.xy) * uCull.camera.z;
+
+	var out: VertexOutput;
+	out.position = vec4f(view.x, view.y * uCull.camera.w, object.placement.w, 1.0);
+	out.color = in.color * object.color.rgb;
+	return out;
+}
+
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4f {
+	return vec4f(in.color, 1.0);
+}
@@ -0,0 +1,60 @@
+struct OverlayUniforms {
+    rect: vec4f,   // left, bottom, width, height in clip space
+    scale: vec4f,  // ms at the top of the graph, sample count, frame budget ms, warning ms
+};
+
+@group(0) @binding(0) var<uniform> uOverlay: OverlayUniforms;
+@group(0) @binding(1) var<storage, read> frameTimes: array<f32>;
+
+struct VertexOutput {
+	@builtin(position) position: vec4f,
+	@location(0) color: vec3f,
+};
+
+// One quad per instance: the background, the budget and warning lines, then one bar per frame
+@vertex
+fn vs_main(@builtin(vertex_index) vertex: u32, @builtin(instance_index) instance: u32) -> VertexOutput {
+	var corners = array<vec2f, 6>(
+		vec2f(0.0, 0.0), vec2f(1.0, 0.0), vec2f(1.0, 1.0),
+		vec2f(0.0, 0.0), vec2f(1.0, 1.0), vec2f(0.0, 1.0),
+	);
+	let corner = corners[vertex];
+	let rect = uOverlay.rect;
+	let topMs = uOverlay.scale.x;
+
+	var origin = vec2f(0.0, 0.0);
+	var size = vec2f(1.0, 1.0);
+	var color = vec3f(0.0, 0.0, 0.0);
+	if (instance == 0u) {
+		color = vec3f(0.02, 0.02, 0.02);
+	} else if (instance <= 2u) {
+		let lineMs = select(uOverlay.scale.w, uOverlay.scale.z, instance == 1u);
+		origin = vec2f(0.0, min(lineMs / topMs, 1.0));
+		size = vec2f(1.0, 0.01);
+		color = vec3f(0.6, 0.6, 0.6);
+	} else {
+		let bar = instance - 3u;
+		let ms = frameTimes[bar];
+		let width = 1.0 / uOverlay.scale.y;
+		origin = vec2f(f32(bar) * width, 0.0);
+		size = vec2f(width * 0.8, min(ms / topMs, 1.0));
+		if (ms <= uOverlay.scale.z) {
+			color = vec3f(0.2, 0.8, 0.3);
+		} else if (ms <= uOverlay.scale.w) {
+			color = vec3f(0.9, 0.8, 0.2);
+		} else {
+			color = vec3f(0.9, 0.2, 0.2);
+		}
+	}
+
+	let position = rect.xy + (origin + corner * size) * rect.zw;
+	var out: VertexOutput;
+	out.position = vec4f(position, 0.0, 1.0);
+	out.color = color;
+	return out;
+}
+
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4f {
+	return vec4f(in.color, 0.8);
+}
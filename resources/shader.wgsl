@@ -3,10 +3,15 @@
 struct MyUniforms {
     color: vec4f,
     time: f32,
+    aspectRatio: f32,
+    depth: f32,
 };
 
 @group(0) @binding(0) var<uniform> uMyUniforms: MyUniforms;
 
+// Set per pipeline so that otherwise identical pipelines stay distinct
+override brightness: f32 = 1.0;
+
 struct VertexInput {
 	@location(0) position: vec2f,
 	@location(1) color: vec3f,
@@ -21,17 +26,17 @@ struct VertexOutput {
 @vertex
 fn vs_main(in: VertexInput) -> VertexOutput {
 	var out: VertexOutput;
-	let ratio = 640.0 / 480.0;
+	let ratio = uMyUniforms.aspectRatio;
 	var offset = vec2f(-0.6875, -0.463);
     offset += 0.3 * vec2f(cos(uMyUniforms.time), sin(uMyUniforms.time));
-	out.position = vec4<f32>(in.position.x + offset.x, (in.position.y + offset.y) * ratio, 0.0, 1.0);
+	out.position = vec4<f32>(in.position.x + offset.x, (in.position.y + offset.y) * ratio, uMyUniforms.depth, 1.0);
 	out.color = in.color;
 	return out;
 }
 
 @fragment
 fn fs_main(in: VertexOutput) -> @location(0) vec4f {
-    let color = in.color * uMyUniforms.color.rgb;
+    let color = in.color * uMyUniforms.color.rgb * brightness;
 
     let corrected_color = pow(color, vec3f(1));
 	return vec4f(corrected_color, uMyUniforms.color.a);
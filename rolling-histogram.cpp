@@ -0,0 +1,113 @@
+#include "rolling-histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <ostream>
+#include <string>
+
+RollingHistogram::RollingHistogram(size_t capacity)
+    : m_Samples(std::max<size_t>(capacity, 1))
+{
+}
+
+void RollingHistogram::Add(double value)
+{
+    m_Samples[m_Next] = value;
+    m_Next = (m_Next + 1) % m_Samples.size();
+    m_Count = std::min(m_Count + 1, m_Samples.size());
+}
+
+void RollingHistogram::Clear()
+{
+    m_Next = 0;
+    m_Count = 0;
+}
+
+double RollingHistogram::GetLatest() const
+{
+    if (m_Count == 0) return 0.0;
+    return m_Samples[(m_Next + m_Samples.size() - 1) % m_Samples.size()];
+}
+
+double RollingHistogram::GetRecent(size_t age) const
+{
+    if (age >= m_Count) return 0.0;
+    return m_Samples[(m_Next + m_Samples.size() - 1 - age) % m_Samples.size()];
+}
+
+double RollingHistogram::GetMean() const
+{
+    if (m_Count == 0) return 0.0;
+    return std::accumulate(m_Samples.begin(), m_Samples.begin() + m_Count, 0.0) / static_cast<double>(m_Count);
+}
+
+double RollingHistogram::GetMin() const
+{
+    if (m_Count == 0) return 0.0;
+    return *std::min_element(m_Samples.begin(), m_Samples.begin() + m_Count);
+}
+
+double RollingHistogram::GetMax() const
+{
+    if (m_Count == 0) return 0.0;
+    return *std::max_element(m_Samples.begin(), m_Samples.begin() + m_Count);
+}
+
+double RollingHistogram::GetPercentile(double p) const
+{
+    if (m_Count == 0) return 0.0;
+    const std::vector<double> sorted = SortedSamples();
+    const size_t rank = static_cast<size_t>(std::ceil(std::clamp(p, 0.0, 1.0) * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+std::vector<uint32_t> RollingHistogram::GetBuckets(uint32_t bucketCount, double& low, double& high) const
+{
+    std::vector<uint32_t> buckets(std::max(bucketCount, 1u), 0);
+    low = GetMin();
+    high = GetMax();
+    const double width = (high - low) / static_cast<double>(buckets.size());
+    for (size_t i = 0; i < m_Count; ++i)
+    {
+        const size_t bucket = width > 0.0 ? static_cast<size_t>((m_Samples[i] - low) / width) : 0;
+        ++buckets[std::min(bucket, buckets.size() - 1)];
+    }
+    return buckets;
+}
+
+void RollingHistogram::Print(std::ostream& out, const char* unit, uint32_t bucketCount) const
+{
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "  mean " << GetMean() << ' ' << unit
+        << ", p50 " << GetPercentile(0.5) << ", p95 " << GetPercentile(0.95) << ", p99 " << GetPercentile(0.99)
+        << ", max " << GetMax() << " (" << m_Count << " samples)\n";
+    if (m_Count == 0)
+    {
+        out.flags(flags);
+        out.precision(precision);
+        return;
+    }
+
+    double low = 0.0, high = 0.0;
+    const std::vector<uint32_t> buckets = GetBuckets(bucketCount, low, high);
+    const uint32_t largest = *std::max_element(buckets.begin(), buckets.end());
+    const double width = (high - low) / static_cast<double>(buckets.size());
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        const size_t bar = largest > 0 ? buckets[i] * 40 / largest : 0;
+        out << "  " << std::setw(9) << low + width * static_cast<double>(i) << ' ' << unit << " | "
+            << std::string(bar, '#') << ' ' << buckets[i] << '\n';
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+std::vector<double> RollingHistogram::SortedSamples() const
+{
+    std::vector<double> sorted(m_Samples.begin(), m_Samples.begin() + m_Count);
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// Keeps the last N samples of a measurement and summarizes them as percentiles and a bucketed histogram.
+class RollingHistogram
+{
+public:
+    explicit RollingHistogram(size_t capacity = 256);
+
+    void Add(double value);
+    void Clear();
+
+    size_t GetCount() const { return m_Count; }
+    double GetLatest() const;
+    // age 0 is the latest sample, GetCount() - 1 the oldest one still in the window
+    double GetRecent(size_t age) const;
+    double GetMean() const;
+    double GetMin() const;
+    double GetMax() const;
+    // p in [0, 1], nearest-rank over the current window
+    double GetPercentile(double p) const;
+
+    // Counts per bucket, the buckets evenly split [low, high] of the current window
+    std::vector<uint32_t> GetBuckets(uint32_t bucketCount, double& low, double& high) const;
+    void Print(std::ostream& out, const char* unit, uint32_t bucketCount = 10) const;
+
+private:
+    std::vector<double> SortedSamples() const;
+
+    std::vector<double> m_Samples;
+    size_t m_Next{};
+    size_t m_Count{};
+};
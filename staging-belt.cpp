@@ -0,0 +1,190 @@
+#include "staging-belt.h"
+#include "gpu-tracker.h"
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <thread>
+
+using namespace wgpu;
+
+void StagingBelt::Init(Device device, uint64_t chunkSize, uint32_t maxIdleFrames)
+{
+    m_Device = device;
+    m_ChunkSize = chunkSize;
+    m_MaxIdleFrames = maxIdleFrames;
+    m_Frame = 0;
+    m_Chunks.clear();
+    m_UploadedBytes = 0;
+    m_FailedCount = 0;
+    m_RetiredCount = 0;
+    m_PeakChunkCount = 0;
+}
+
+void* StagingBelt::Upload(CommandEncoder encoder, Buffer destination, uint64_t destinationOffset, uint64_t size)
+{
+    if (destinationOffset % 4 != 0)
+    {
+        return nullptr;
+    }
+    const std::optional<Slice> slice = Allocate(size);
+    if (!slice)
+    {
+        return nullptr;
+    }
+    Copy(encoder, *slice, destination, destinationOffset);
+    return slice->data;
+}
+
+bool StagingBelt::Write(CommandEncoder encoder, Buffer destination, uint64_t destinationOffset, const void* data, uint64_t size)
+{
+    void* target = Upload(encoder, destination, destinationOffset, size);
+    if (!target)
+    {
+        return false;
+    }
+    std::memcpy(target, data, size);
+    return true;
+}
+
+std::optional<StagingBelt::Slice> StagingBelt::Allocate(uint64_t size)
+{
+    if (size == 0 || size % 4 != 0)
+    {
+        return std::nullopt;
+    }
+
+    Chunk* chunk = AcquireChunk(size);
+    if (!chunk)
+    {
+        ++m_FailedCount;
+        return std::nullopt;
+    }
+    chunk->lastUsedFrame = m_Frame;
+    const uint64_t offset = chunk->used;
+    chunk->used += size;
+    return Slice{ chunk->buffer, offset, size, chunk->data + offset };
+}
+
+void StagingBelt::Copy(CommandEncoder encoder, const Slice& slice, Buffer destination, uint64_t destinationOffset)
+{
+    m_UploadedBytes += slice.size;
+    encoder.copyBufferToBuffer(slice.buffer, slice.offset, destination, destinationOffset, slice.size);
+}
+
+void StagingBelt::Finish()
+{
+    for (auto& chunk : m_Chunks)
+    {
+        if (chunk->state == ChunkState::Active)
+        {
+            chunk->buffer.unmap();
+            chunk->data = nullptr;
+            chunk->state = ChunkState::Closed;
+        }
+    }
+}
+
+void StagingBelt::Recall()
+{
+    ++m_Frame;
+    // A spike leaves chunks nobody needs afterwards. Free ones are mapped and have no callback pending.
+    const size_t chunkCount = m_Chunks.size();
+    std::erase_if(m_Chunks, [this](std::unique_ptr<Chunk>& chunk) {
+        if (chunk->state != ChunkState::Free || m_Frame - chunk->lastUsedFrame <= m_MaxIdleFrames)
+        {
+            return false;
+        }
+        GpuTracker::Release(chunk->buffer);
+        return true;
+    });
+    m_RetiredCount += chunkCount - m_Chunks.size();
+
+    for (auto& chunkPtr : m_Chunks)
+    {
+        Chunk& chunk = *chunkPtr;
+        if (chunk.state != ChunkState::Closed)
+        {
+            continue;
+        }
+        // The map only completes once the copies that read the chunk are done
+        chunk.state = ChunkState::Mapping;
+        auto onMapped = [](WGPUBufferMapAsyncStatus status, void* pUserData) {
+            Chunk& chunk = *reinterpret_cast<Chunk*>(pUserData);
+            chunk.used = 0;
+            chunk.state = status == WGPUBufferMapAsyncStatus_Success ? ChunkState::Free : ChunkState::Closed;
+        };
+        wgpuBufferMapAsync(chunk.buffer, WGPUMapMode_Write, 0, chunk.size, onMapped, &chunk);
+    }
+}
+
+void StagingBelt::Release()
+{
+    // The map callbacks point at the chunks, they have to fire before the chunks go away
+    while (std::any_of(m_Chunks.begin(), m_Chunks.end(), [](const auto& chunk) { return chunk->state == ChunkState::Mapping; }))
+    {
+#ifdef WEBGPU_BACKEND_DAWN
+        m_Device.tick();
+#endif
+        std::this_thread::yield();
+    }
+    for (auto& chunk : m_Chunks)
+    {
+        GpuTracker::Release(chunk->buffer);
+    }
+    m_Chunks.clear();
+}
+
+StagingBelt::Chunk* StagingBelt::AcquireChunk(uint64_t size)
+{
+    for (auto& chunk : m_Chunks)
+    {
+        if (chunk->state == ChunkState::Active && chunk->size - chunk->used >= size)
+        {
+            return chunk.get();
+        }
+    }
+    for (auto& chunk : m_Chunks)
+    {
+        if (chunk->state == ChunkState::Free && chunk->size >= size)
+        {
+            chunk->data = static_cast<uint8_t*>(chunk->buffer.getMappedRange(0, chunk->size));
+            if (!chunk->data)
+            {
+                // Still mapped, so unmap it first and let the next Recall try to map it again
+                chunk->buffer.unmap();
+                chunk->state = ChunkState::Closed;
+                continue;
+            }
+            chunk->used = 0;
+            chunk->state = ChunkState::Active;
+            return chunk.get();
+        }
+    }
+
+    // Nothing free is large enough, uploads bigger than a chunk get one of their own
+    auto chunk = std::make_unique<Chunk>();
+    chunk->size = std::max<uint64_t>(m_ChunkSize, (size + 3) & ~3ull);
+    chunk->buffer = GpuTracker::CreateBuffer(m_Device, BufferDescriptor
+    {{
+        .label = "Staging Chunk",
+        .usage = BufferUsage::MapWrite | BufferUsage::CopySrc,
+        .size = chunk->size,
+        .mappedAtCreation = true,
+    }}, GpuTracker::Category::Staging);
+    chunk->data = static_cast<uint8_t*>(chunk->buffer.getMappedRange(0, chunk->size));
+    if (!chunk->data)
+    {
+        GpuTracker::Release(chunk->buffer);
+        return nullptr;
+    }
+    chunk->state = ChunkState::Active;
+    m_Chunks.push_back(std::move(chunk));
+    m_PeakChunkCount = std::max(m_PeakChunkCount, m_Chunks.size());
+    return m_Chunks.back().get();
+}
+
+void StagingBelt::PrintReport(std::ostream& out) const
+{
+    out << "Staging belt: " << m_UploadedBytes / 1024 << " KB uploaded, " << m_Chunks.size() << " chunks (peak "
+        << m_PeakChunkCount << ", " << m_RetiredCount << " retired), " << m_FailedCount << " failed uploads\n";
+}
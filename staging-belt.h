@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+
+// Uploads through a pool of persistently re-mapped MapWrite | CopySrc buffers. The CPU writes
+// straight into mapped memory and every upload becomes a copyBufferToBuffer in the caller's
+// encoder, so the uploads of a frame ride along with its one submit instead of each
+// queue.writeBuffer copying into a staging area of its own.
+//
+// Per frame: Upload/Write while recording, Finish before the encoder is submitted (the chunks are
+// unmapped for the copies), Recall after the submit. A recalled chunk is mapped again once the GPU
+// has read it and then serves later uploads; the belt grows when the GPU falls behind and shrinks
+// again once chunks stayed free for maxIdleFrames recalls.
+class StagingBelt
+{
+public:
+    static constexpr uint64_t DefaultChunkSize = 1 << 20;
+    static constexpr uint32_t DefaultMaxIdleFrames = 120;
+
+    // Mapped staging space that nothing reads until it is passed to Copy
+    struct Slice
+    {
+        wgpu::Buffer buffer{nullptr};
+        uint64_t offset{};
+        uint64_t size{};
+        void* data{};
+    };
+
+    void Init(wgpu::Device device, uint64_t chunkSize = DefaultChunkSize, uint32_t maxIdleFrames = DefaultMaxIdleFrames);
+    // Space for size bytes that land at destinationOffset once the encoder runs, valid until Finish.
+    // Offset and size must be multiples of 4, as for any buffer copy. nullptr when mapping failed.
+    void* Upload(wgpu::CommandEncoder encoder, wgpu::Buffer destination, uint64_t destinationOffset, uint64_t size);
+    bool Write(wgpu::CommandEncoder encoder, wgpu::Buffer destination, uint64_t destinationOffset, const void* data, uint64_t size);
+    // The two halves of Upload, for callers that need several slices before they record any copy.
+    // A slice that is never copied only costs its staging space until the next Recall.
+    std::optional<Slice> Allocate(uint64_t size);
+    void Copy(wgpu::CommandEncoder encoder, const Slice& slice, wgpu::Buffer destination, uint64_t destinationOffset);
+    void Finish();
+    // Once per frame, also retires the chunks that stayed free for too long
+    void Recall();
+    // Waits for pending mappings, the chunks must not be in use by the GPU anymore
+    void Release();
+
+    size_t GetChunkCount() const { return m_Chunks.size(); }
+    uint64_t GetUploadedBytes() const { return m_UploadedBytes; }
+    // Uploads that got no staging space because a chunk could not be mapped
+    uint64_t GetFailedCount() const { return m_FailedCount; }
+    void PrintReport(std::ostream& out) const;
+
+private:
+    enum class ChunkState
+    {
+        Free,
+        Active,
+        Closed,
+        Mapping,
+    };
+
+    struct Chunk
+    {
+        wgpu::Buffer buffer{nullptr};
+        uint64_t size{};
+        uint64_t used{};
+        uint8_t* data{};
+        uint64_t lastUsedFrame{};
+        std::atomic<ChunkState> state{ChunkState::Free};
+    };
+
+    Chunk* AcquireChunk(uint64_t size);
+
+    wgpu::Device m_Device{nullptr};
+    uint64_t m_ChunkSize{DefaultChunkSize};
+    uint32_t m_MaxIdleFrames{DefaultMaxIdleFrames};
+    uint64_t m_Frame{};
+    std::vector<std::unique_ptr<Chunk>> m_Chunks;
+    uint64_t m_UploadedBytes{};
+    uint64_t m_FailedCount{};
+    uint64_t m_RetiredCount{};
+    size_t m_PeakChunkCount{};
+};
@@ -0,0 +1,160 @@
+#include "task-graph.h"
+#include "cpu-profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+TaskGraph::TaskId TaskGraph::Add(const char* name, std::function<bool()> run, std::vector<TaskId> dependencies, Affinity affinity)
+{
+    m_Tasks.push_back(Task{ name, std::move(run), std::move(dependencies), affinity });
+    return static_cast<TaskId>(m_Tasks.size() - 1);
+}
+
+bool TaskGraph::Run(uint32_t workerCount)
+{
+#ifdef __EMSCRIPTEN__
+    // No threads without pthread support in the build
+    workerCount = 0;
+#endif
+    const auto start = std::chrono::steady_clock::now();
+    auto nowMs = [start] { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); };
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool finished = false;
+
+    // Picks a queued task this thread may run, with the mutex held
+    auto takeTask = [this](bool mainThread, bool hasWorkers) -> Task* {
+        for (Task& task : m_Tasks)
+        {
+            if (task.status == Status::Queued && (task.affinity == Affinity::Main) == mainThread)
+            {
+                return &task;
+            }
+        }
+        if (mainThread && !hasWorkers)
+        {
+            auto queued = std::find_if(m_Tasks.begin(), m_Tasks.end(), [](const Task& task) { return task.status == Status::Queued; });
+            return queued != m_Tasks.end() ? &*queued : nullptr;
+        }
+        return nullptr;
+    };
+
+    auto execute = [&](Task& task, std::unique_lock<std::mutex>& lock, bool mainThread) {
+        task.status = Status::Running;
+        task.ranOnMain = mainThread;
+        task.startMs = nowMs();
+        lock.unlock();
+        bool success;
+        {
+            PROFILE_ZONE(task.name);
+            success = task.run();
+        }
+        lock.lock();
+        task.endMs = nowMs();
+        task.status = success ? Status::Succeeded : Status::Failed;
+        finished = !Schedule();
+        condition.notify_all();
+    };
+
+    std::vector<std::thread> workers;
+    {
+        std::unique_lock lock(mutex);
+        finished = !Schedule();
+        for (uint32_t i = 0; i < workerCount; ++i)
+        {
+            workers.emplace_back([&] {
+                CpuProfiler::SetThreadName("Startup Worker");
+                std::unique_lock lock(mutex);
+                while (true)
+                {
+                    Task* task = nullptr;
+                    condition.wait(lock, [&] { return finished || (task = takeTask(false, true)) != nullptr; });
+                    if (!task)
+                    {
+                        return;
+                    }
+                    execute(*task, lock, false);
+                }
+            });
+        }
+
+        while (true)
+        {
+            Task* task = nullptr;
+            condition.wait(lock, [&] { return finished || (task = takeTask(true, workerCount > 0)) != nullptr; });
+            if (!task)
+            {
+                break;
+            }
+            execute(*task, lock, true);
+        }
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    m_ElapsedMs = nowMs();
+    return std::all_of(m_Tasks.begin(), m_Tasks.end(), [](const Task& task) { return task.status == Status::Succeeded; });
+}
+
+void TaskGraph::PrintTimeline(std::ostream& out) const
+{
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(1) << "Startup took " << m_ElapsedMs << " ms\n";
+    for (const Task& task : m_Tasks)
+    {
+        out << "  " << std::left << std::setw(20) << task.name << std::right;
+        if (task.status == Status::Skipped)
+        {
+            out << "skipped\n";
+            continue;
+        }
+        out << (task.ranOnMain ? "main   " : "worker ") << std::setw(8) << task.startMs << " ms +" << std::setw(8) << task.endMs - task.startMs << " ms"
+            << (task.status == Status::Failed ? "  failed" : "") << '\n';
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool TaskGraph::Schedule()
+{
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (Task& task : m_Tasks)
+        {
+            if (task.status != Status::Waiting)
+            {
+                continue;
+            }
+            bool ready = true;
+            for (TaskId dependency : task.dependencies)
+            {
+                const Status status = m_Tasks[dependency].status;
+                if (status == Status::Failed || status == Status::Skipped)
+                {
+                    // Skipping may unblock the decision for tasks further down, look again
+                    task.status = Status::Skipped;
+                    changed = true;
+                    break;
+                }
+                ready = ready && status == Status::Succeeded;
+            }
+            if (task.status == Status::Waiting && ready)
+            {
+                task.status = Status::Queued;
+            }
+        }
+    }
+    return std::any_of(m_Tasks.begin(), m_Tasks.end(), [](const Task& task) {
+        return task.status == Status::Waiting || task.status == Status::Queued || task.status == Status::Running;
+    });
+}
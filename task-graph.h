@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Runs a handful of dependent tasks once each, for startup work. A task starts as soon as all of its
+// dependencies succeeded. Main tasks run on the calling thread (window and device work that must stay
+// there), the others on short-lived workers. When a task fails, its dependents are skipped.
+class TaskGraph
+{
+public:
+    using TaskId = uint32_t;
+
+    enum class Affinity
+    {
+        Worker,
+        Main,
+    };
+
+    TaskId Add(const char* name, std::function<bool()> run, std::vector<TaskId> dependencies = {}, Affinity affinity = Affinity::Worker);
+    // True when every task succeeded. Without workers everything runs on the calling thread.
+    bool Run(uint32_t workerCount = 2);
+
+    // When each task ran and on which thread, relative to the start of Run()
+    void PrintTimeline(std::ostream& out) const;
+    double GetElapsedMs() const { return m_ElapsedMs; }
+
+private:
+    enum class Status
+    {
+        Waiting,
+        Queued,
+        Running,
+        Succeeded,
+        Failed,
+        Skipped,
+    };
+
+    struct Task
+    {
+        const char* name;
+        std::function<bool()> run;
+        std::vector<TaskId> dependencies;
+        Affinity affinity;
+        Status status{Status::Waiting};
+        bool ranOnMain{false};
+        double startMs{};
+        double endMs{};
+    };
+
+    // Queues the tasks whose dependencies are done, with the mutex held. False once nothing can run anymore.
+    bool Schedule();
+
+    std::vector<Task> m_Tasks;
+    double m_ElapsedMs{};
+};
@@ -0,0 +1,215 @@
+#include "transient-pool.h"
+#include "cpu-profiler.h"
+#include "gpu-tracker.h"
+#include <algorithm>
+#include <ostream>
+
+using namespace wgpu;
+
+void TransientPool::Init(Device device, FrameContextManager& frames, uint64_t budgetBytes, uint32_t maxIdleFrames)
+{
+    m_Device = device;
+    m_Frames = &frames;
+    m_BudgetBytes = budgetBytes;
+    m_MaxIdleFrames = maxIdleFrames;
+    m_Frame = 0;
+    m_Stats = Stats{};
+}
+
+void TransientPool::Release()
+{
+    m_Textures.clear();
+    m_Buffers.clear();
+    m_PooledBytes = 0;
+    m_Device = nullptr;
+    m_Frames = nullptr;
+}
+
+TransientPool::PooledTexture TransientPool::AcquireTexture(const TextureDescriptor& descriptor)
+{
+    ++m_Stats.requests;
+    const TextureKey key = MakeKey(descriptor);
+    auto entry = std::find_if(m_Textures.begin(), m_Textures.end(), [&](const TextureEntry& candidate) {
+        return !candidate.inUse && candidate.key == key;
+    });
+    if (entry != m_Textures.end())
+    {
+        ++m_Stats.hits;
+    }
+    else
+    {
+        PROFILE_ZONE("TransientPool::CreateTexture");
+        GpuHandle<Texture> texture{GpuTracker::CreateTexture(m_Device, descriptor, GpuTracker::Category::RenderTarget)};
+        GpuHandle<TextureView> view{TextureView{wgpuTextureCreateView(texture.Get(), nullptr)}};
+        const uint64_t bytes = GpuTracker::EstimateTextureBytes(descriptor);
+        m_Textures.push_back(TextureEntry{ key, std::move(texture), std::move(view), bytes });
+        m_PooledBytes += bytes;
+        ++m_Stats.created;
+        ++m_Stats.createdThisFrame;
+        entry = m_Textures.end() - 1;
+    }
+    entry->inUse = true;
+    entry->lastUsedFrame = m_Frame;
+    return PooledTexture{ entry->texture.Get(), entry->view.Get() };
+}
+
+void TransientPool::ReleaseTexture(Texture texture)
+{
+    auto entry = std::find_if(m_Textures.begin(), m_Textures.end(), [&](const TextureEntry& candidate) {
+        return candidate.texture.Get() == texture;
+    });
+    if (entry != m_Textures.end())
+    {
+        entry->inUse = false;
+        entry->lastUsedFrame = m_Frame;
+    }
+}
+
+Buffer TransientPool::AcquireBuffer(const BufferDescriptor& descriptor)
+{
+    ++m_Stats.requests;
+    const BufferKey key = MakeKey(descriptor);
+    auto entry = std::find_if(m_Buffers.begin(), m_Buffers.end(), [&](const BufferEntry& candidate) {
+        return !candidate.inUse && candidate.key == key;
+    });
+    if (entry != m_Buffers.end())
+    {
+        ++m_Stats.hits;
+    }
+    else
+    {
+        PROFILE_ZONE("TransientPool::CreateBuffer");
+        m_Buffers.push_back(BufferEntry{ key, GpuHandle{GpuTracker::CreateBuffer(m_Device, descriptor, GpuTracker::Category::Storage)} });
+        m_PooledBytes += descriptor.size;
+        ++m_Stats.created;
+        ++m_Stats.createdThisFrame;
+        entry = m_Buffers.end() - 1;
+    }
+    entry->inUse = true;
+    entry->lastUsedFrame = m_Frame;
+    return entry->buffer.Get();
+}
+
+void TransientPool::ReleaseBuffer(Buffer buffer)
+{
+    auto entry = std::find_if(m_Buffers.begin(), m_Buffers.end(), [&](const BufferEntry& candidate) {
+        return candidate.buffer.Get() == buffer;
+    });
+    if (entry != m_Buffers.end())
+    {
+        entry->inUse = false;
+        entry->lastUsedFrame = m_Frame;
+    }
+}
+
+void TransientPool::EndFrame()
+{
+    Evict();
+    m_Stats.createdLastFrame = m_Stats.createdThisFrame;
+    m_Stats.createdThisFrame = 0;
+    ++m_Frame;
+}
+
+uint64_t TransientPool::GetFreeBytes() const
+{
+    uint64_t bytes = 0;
+    for (const TextureEntry& entry : m_Textures)
+    {
+        bytes += entry.inUse ? 0 : entry.bytes;
+    }
+    for (const BufferEntry& entry : m_Buffers)
+    {
+        bytes += entry.inUse ? 0 : entry.key.size;
+    }
+    return bytes;
+}
+
+void TransientPool::PrintReport(std::ostream& out) const
+{
+    out << "Transient pool: " << m_Stats.requests << " requests, " << GetHitRate() * 100.0 << "% hits, "
+        << m_Stats.created << " created, " << m_Stats.evicted << " evicted, " << m_Stats.createdLastFrame << " created in the last frame, "
+        << m_PooledBytes / 1024 << " KB pooled (" << GetFreeBytes() / 1024 << " KB free, budget " << (m_BudgetBytes >> 20) << " MB)\n";
+}
+
+TransientPool::TextureKey TransientPool::MakeKey(const TextureDescriptor& descriptor)
+{
+    return TextureKey{ descriptor.size.width, descriptor.size.height, descriptor.size.depthOrArrayLayers, descriptor.format,
+        descriptor.dimension, descriptor.mipLevelCount, descriptor.sampleCount, descriptor.usage };
+}
+
+TransientPool::BufferKey TransientPool::MakeKey(const BufferDescriptor& descriptor)
+{
+    return BufferKey{ descriptor.size, descriptor.usage };
+}
+
+void TransientPool::Evict()
+{
+    const uint64_t before = m_Textures.size() + m_Buffers.size();
+    auto idle = [this](uint64_t lastUsedFrame) { return m_Frame - lastUsedFrame > m_MaxIdleFrames; };
+    for (auto entry = m_Textures.begin(); entry != m_Textures.end();)
+    {
+        if (!entry->inUse && idle(entry->lastUsedFrame))
+        {
+            Retire(*entry);
+            entry = m_Textures.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+    for (auto entry = m_Buffers.begin(); entry != m_Buffers.end();)
+    {
+        if (!entry->inUse && idle(entry->lastUsedFrame))
+        {
+            Retire(*entry);
+            entry = m_Buffers.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+
+    // Over budget, the free entries go from the least recently used on
+    while (m_PooledBytes > m_BudgetBytes)
+    {
+        auto texture = std::min_element(m_Textures.begin(), m_Textures.end(), [](const TextureEntry& a, const TextureEntry& b) {
+            return (a.inUse ? UINT64_MAX : a.lastUsedFrame) < (b.inUse ? UINT64_MAX : b.lastUsedFrame);
+        });
+        auto buffer = std::min_element(m_Buffers.begin(), m_Buffers.end(), [](const BufferEntry& a, const BufferEntry& b) {
+            return (a.inUse ? UINT64_MAX : a.lastUsedFrame) < (b.inUse ? UINT64_MAX : b.lastUsedFrame);
+        });
+        const bool textureFree = texture != m_Textures.end() && !texture->inUse;
+        const bool bufferFree = buffer != m_Buffers.end() && !buffer->inUse;
+        if (textureFree && (!bufferFree || texture->lastUsedFrame <= buffer->lastUsedFrame))
+        {
+            Retire(*texture);
+            m_Textures.erase(texture);
+        }
+        else if (bufferFree)
+        {
+            Retire(*buffer);
+            m_Buffers.erase(buffer);
+        }
+        else
+        {
+            // Everything left is handed out
+            break;
+        }
+    }
+    m_Stats.evicted += before - (m_Textures.size() + m_Buffers.size());
+}
+
+void TransientPool::Retire(TextureEntry& entry)
+{
+    m_PooledBytes -= entry.bytes;
+    m_Frames->DeferRelease(std::move(entry.view));
+    m_Frames->DeferRelease(std::move(entry.texture));
+}
+
+void TransientPool::Retire(BufferEntry& entry)
+{
+    m_PooledBytes -= entry.key.size;
+    m_Frames->DeferRelease(std::move(entry.buffer));
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include <webgpu/webgpu.hpp>
+#include "frame-context.h"
+#include "gpu-handle.h"
+
+// Recycles textures and buffers that only live for part of a frame. A request is matched against the
+// free entries by descriptor (size, format, usage and sample count for textures, size and usage for
+// buffers) and only creates an object when none fits, so a frame that looks like the last one
+// allocates nothing. Released entries stay around until they were idle for maxIdleFrames, or until
+// the pool is over its budget, then the least recently used free ones go first. Entries handed out
+// are never evicted. Work that used an entry was submitted before it came back, and the queue runs
+// in order, so the next frame can take it right away. An evicted entry may still be used by a frame
+// in flight, it is only destroyed once the current frame slot retires.
+class TransientPool
+{
+public:
+    static constexpr uint64_t DefaultBudgetBytes = 256ull << 20;
+    static constexpr uint32_t DefaultMaxIdleFrames = 120;
+
+    struct PooledTexture
+    {
+        wgpu::Texture texture{nullptr};
+        // Default view of the whole texture, owned by the pool too
+        wgpu::TextureView view{nullptr};
+    };
+
+    struct Stats
+    {
+        uint64_t requests{};
+        uint64_t hits{};
+        uint64_t created{};
+        uint64_t evicted{};
+        // Objects created since the last EndFrame(), 0 once the app has warmed up
+        uint32_t createdThisFrame{};
+        uint32_t createdLastFrame{};
+    };
+
+    void Init(wgpu::Device device, FrameContextManager& frames, uint64_t budgetBytes = DefaultBudgetBytes, uint32_t maxIdleFrames = DefaultMaxIdleFrames);
+    // Destroys every entry, the ones still handed out included
+    void Release();
+
+    PooledTexture AcquireTexture(const wgpu::TextureDescriptor& descriptor);
+    void ReleaseTexture(wgpu::Texture texture);
+    // Buffers the CPU never maps, written and read on the GPU only
+    wgpu::Buffer AcquireBuffer(const wgpu::BufferDescriptor& descriptor);
+    void ReleaseBuffer(wgpu::Buffer buffer);
+
+    // Call once per frame after the submit: ages the free entries and evicts what is too old or over budget
+    void EndFrame();
+
+    const Stats& GetStats() const { return m_Stats; }
+    double GetHitRate() const { return m_Stats.requests > 0 ? static_cast<double>(m_Stats.hits) / static_cast<double>(m_Stats.requests) : 0.0; }
+    uint64_t GetPooledBytes() const { return m_PooledBytes; }
+    uint64_t GetFreeBytes() const;
+    void PrintReport(std::ostream& out) const;
+
+private:
+    struct TextureKey
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t layers;
+        wgpu::TextureFormat format;
+        wgpu::TextureDimension dimension;
+        uint32_t mipLevelCount;
+        uint32_t sampleCount;
+        WGPUTextureUsageFlags usage;
+
+        bool operator==(const TextureKey&) const = default;
+    };
+
+    struct BufferKey
+    {
+        uint64_t size;
+        WGPUBufferUsageFlags usage;
+
+        bool operator==(const BufferKey&) const = default;
+    };
+
+    struct TextureEntry
+    {
+        TextureKey key;
+        GpuHandle<wgpu::Texture> texture;
+        GpuHandle<wgpu::TextureView> view;
+        uint64_t bytes{};
+        uint64_t lastUsedFrame{};
+        bool inUse{false};
+    };
+
+    struct BufferEntry
+    {
+        BufferKey key;
+        GpuHandle<wgpu::Buffer> buffer;
+        uint64_t lastUsedFrame{};
+        bool inUse{false};
+    };
+
+    static TextureKey MakeKey(const wgpu::TextureDescriptor& descriptor);
+    static BufferKey MakeKey(const wgpu::BufferDescriptor& descriptor);
+    void Evict();
+    void Retire(TextureEntry& entry);
+    void Retire(BufferEntry& entry);
+
+    wgpu::Device m_Device{nullptr};
+    FrameContextManager* m_Frames{nullptr};
+    uint64_t m_BudgetBytes{DefaultBudgetBytes};
+    uint32_t m_MaxIdleFrames{DefaultMaxIdleFrames};
+    uint64_t m_Frame{};
+    uint64_t m_PooledBytes{};
+    std::vector<TextureEntry> m_Textures;
+    std::vector<BufferEntry> m_Buffers;
+    Stats m_Stats;
+};
@@ -1,63 +1,162 @@
 #include "webgpu-utils.h"
-#include <cassert>
 #include <iostream>
+#include <sstream>
+#include <thread>
 #include <vector>
 
-WGPUAdapter requestAdapter(WGPUInstance instance, const WGPURequestAdapterOptions* options)
-{
-    struct UserData
-    {
-        WGPUAdapter adapter{};
-        bool requestEnded{false};
-    };
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#endif
 
-    UserData userData;
+namespace
+{
+	// Blocking calls give up after this long, a lost GPU process should not hang the app forever
+	constexpr double DefaultTimeoutSeconds = 10.0;
 
-    auto onAdapterRequestEnded = [](WGPURequestAdapterStatus status, WGPUAdapter adapter, const char* message, void* pUserData) {
-        UserData& userData = *reinterpret_cast<UserData*>(pUserData);
-        if (status == WGPURequestAdapterStatus_Success) {
-            userData.adapter = adapter;
-        } else {
-            std::cout << "Could not get WebGPU adapter: " << message << '\n';
-        }
-        userData.requestEnded = true;
-    };
+	void releaseResult(WGPUAdapter adapter) { wgpuAdapterRelease(adapter); }
+	void releaseResult(WGPUDevice device) { wgpuDeviceRelease(device); }
 
-    wgpuInstanceRequestAdapter(instance, options, onAdapterRequestEnded, &userData);
+	template<typename T>
+	void endRequest(PendingRequest<T>& request, T result, const char* message)
+	{
+		if (request.settled.exchange(true))
+		{
+			// The waiter timed out already
+			if (result)
+			{
+				releaseResult(result);
+			}
+			return;
+		}
+		request.result = result;
+		request.message = message ? message : "";
+		request.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - request.start).count();
+		request.ended = true;
+	}
 
-    assert(userData.requestEnded);
+	// After a timeout: abandons the request unless its callback got there first, true in that case
+	template<typename T>
+	bool endedAfterAll(PendingRequest<T>& request)
+	{
+		if (!request.settled.exchange(true))
+		{
+			return false;
+		}
+		// The callback is filling the request in right now
+		while (!request.ended)
+		{
+			std::this_thread::yield();
+		}
+		return true;
+	}
 
-    return userData.adapter;
+	template<typename T>
+	bool pumpUntilEnded(WGPUInstance instance, PendingRequest<T>& request, double timeoutSeconds)
+	{
+		const auto deadline = request.start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeoutSeconds));
+		while (!request.ended && std::chrono::steady_clock::now() < deadline)
+		{
+#ifdef __EMSCRIPTEN__
+			// Hands control back to the browser, which delivers the callback
+			emscripten_sleep(1);
+#else
+			if (instance)
+			{
+				wgpuInstanceProcessEvents(instance);
+			}
+			if (!request.ended)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+#endif
+		}
+		return request.ended;
+	}
 }
 
-WGPUDevice requestDevice(WGPUAdapter adapter, WGPUDeviceDescriptor const * descriptor)
+std::shared_ptr<AdapterRequest> requestAdapterAsync(WGPUInstance instance, const WGPURequestAdapterOptions* options)
 {
-	struct UserData {
-		WGPUDevice device = nullptr;
-		bool requestEnded = false;
+	auto request = std::make_shared<AdapterRequest>();
+
+	// The callback holds its own reference, the request may outlive a caller that timed out
+	auto onAdapterRequestEnded = [](WGPURequestAdapterStatus status, WGPUAdapter adapter, const char* message, void* pUserData) {
+		std::unique_ptr<std::shared_ptr<AdapterRequest>> request(reinterpret_cast<std::shared_ptr<AdapterRequest>*>(pUserData));
+		endRequest(**request, status == WGPURequestAdapterStatus_Success ? adapter : nullptr, message);
 	};
-	UserData userData;
+	wgpuInstanceRequestAdapter(instance, options, onAdapterRequestEnded, new std::shared_ptr<AdapterRequest>(request));
+
+	return request;
+}
+
+std::shared_ptr<DeviceRequest> requestDeviceAsync(WGPUAdapter adapter, WGPUDeviceDescriptor const * descriptor)
+{
+	auto request = std::make_shared<DeviceRequest>();
 
 	auto onDeviceRequestEnded = [](WGPURequestDeviceStatus status, WGPUDevice device, char const * message, void * pUserData) {
-		UserData& userData = *reinterpret_cast<UserData*>(pUserData);
-		if (status == WGPURequestDeviceStatus_Success) {
-			userData.device = device;
-		} else {
-			std::cout << "Could not get WebGPU device: " << message << std::endl;
-		}
-		userData.requestEnded = true;
+		std::unique_ptr<std::shared_ptr<DeviceRequest>> request(reinterpret_cast<std::shared_ptr<DeviceRequest>*>(pUserData));
+		endRequest(**request, status == WGPURequestDeviceStatus_Success ? device : nullptr, message);
 	};
+	wgpuAdapterRequestDevice(adapter, descriptor, onDeviceRequestEnded, new std::shared_ptr<DeviceRequest>(request));
 
-	wgpuAdapterRequestDevice(
-		adapter,
-		descriptor,
-		onDeviceRequestEnded,
-		&userData
-	);
+	return request;
+}
 
-	assert(userData.requestEnded);
+bool waitForRequest(WGPUInstance instance, AdapterRequest& request, double timeoutSeconds, bool report)
+{
+	if (!pumpUntilEnded(instance, request, timeoutSeconds) && !endedAfterAll(request)) {
+		std::cout << "Adapter request timed out after " << timeoutSeconds << " s" << std::endl;
+		return false;
+	}
+	if (!report) {
+		return true;
+	}
+	if (request.result) {
+		std::cout << "Picked adapter " << describeAdapter(request.result) << " in " << request.milliseconds << " ms" << std::endl;
+	} else {
+		std::cout << "Could not get WebGPU adapter: " << request.message << std::endl;
+	}
+	return true;
+}
+
+bool waitForRequest(WGPUInstance instance, DeviceRequest& request, double timeoutSeconds, bool report)
+{
+	if (!pumpUntilEnded(instance, request, timeoutSeconds) && !endedAfterAll(request)) {
+		std::cout << "Device request timed out after " << timeoutSeconds << " s" << std::endl;
+		return false;
+	}
+	if (!report) {
+		return true;
+	}
+	if (request.result) {
+		std::cout << "Got device in " << request.milliseconds << " ms" << std::endl;
+	} else {
+		std::cout << "Could not get WebGPU device: " << request.message << std::endl;
+	}
+	return true;
+}
 
-	return userData.device;
+WGPUAdapter requestAdapter(WGPUInstance instance, const WGPURequestAdapterOptions* options)
+{
+	auto request = requestAdapterAsync(instance, options);
+	return waitForRequest(instance, *request, DefaultTimeoutSeconds) ? request->result : nullptr;
+}
+
+WGPUDevice requestDevice(WGPUInstance instance, WGPUAdapter adapter, WGPUDeviceDescriptor const * descriptor)
+{
+	auto request = requestDeviceAsync(adapter, descriptor);
+	return waitForRequest(instance, *request, DefaultTimeoutSeconds) ? request->result : nullptr;
+}
+
+std::string describeAdapter(WGPUAdapter adapter)
+{
+	WGPUAdapterProperties properties = {};
+	properties.nextInChain = nullptr;
+	wgpuAdapterGetProperties(adapter, &properties);
+	std::ostringstream description;
+	description << (properties.name ? properties.name : "unnamed")
+		<< " (backend " << properties.backendType << ", type " << properties.adapterType
+		<< ", vendor 0x" << std::hex << properties.vendorID << ", device 0x" << properties.deviceID << ")";
+	return description.str();
 }
 
 void inspectAdapter(WGPUAdapter adapter) {
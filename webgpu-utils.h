@@ -1,7 +1,40 @@
 #pragma once
 
 #include <webgpu/webgpu.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
 
-WGPUDevice requestDevice(WGPUAdapter adapter, WGPUDeviceDescriptor const * descriptor);
+// An adapter or device request in flight. The callback fills it in and keeps it alive until then,
+// so a caller that gives up after a timeout can simply drop its reference.
+template<typename T>
+struct PendingRequest
+{
+	T result = nullptr;
+	std::atomic<bool> ended = false;
+	// Taken by whichever comes first, the callback or a waiter that timed out. A callback that comes
+	// second releases its result, the waiter is gone and nobody else would.
+	std::atomic<bool> settled = false;
+	std::string message;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	double milliseconds = 0.0;
+};
+using AdapterRequest = PendingRequest<WGPUAdapter>;
+using DeviceRequest = PendingRequest<WGPUDevice>;
+
+// Start a request and return right away, the caller can do other work while it is in flight
+std::shared_ptr<AdapterRequest> requestAdapterAsync(WGPUInstance instance, const WGPURequestAdapterOptions* options);
+std::shared_ptr<DeviceRequest> requestDeviceAsync(WGPUAdapter adapter, WGPUDeviceDescriptor const * descriptor);
+// Process events until the request ended or the timeout passed, false on timeout, in which case the
+// request is abandoned and a late result gets released by its callback. Unless told to keep
+// quiet, reports which adapter was picked (or why there is none) and how long the request took.
+bool waitForRequest(WGPUInstance instance, AdapterRequest& request, double timeoutSeconds, bool report = true);
+bool waitForRequest(WGPUInstance instance, DeviceRequest& request, double timeoutSeconds, bool report = true);
+
+// Blocking versions of the above, nullptr on failure or timeout
+WGPUDevice requestDevice(WGPUInstance instance, WGPUAdapter adapter, WGPUDeviceDescriptor const * descriptor);
 WGPUAdapter requestAdapter(WGPUInstance instance, const WGPURequestAdapterOptions* options);
+// Name, backend and type of the adapter in one line
+std::string describeAdapter(WGPUAdapter adapter);
 void inspectAdapter(WGPUAdapter adapter);
\ No newline at end of file